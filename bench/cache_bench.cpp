@@ -0,0 +1,217 @@
+/**
+ * @file cache_bench.cpp
+ * @brief Replays key-access traces through the cache policies and reports
+ *        hit ratio, throughput and heap bytes per entry.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -pthread -Isrc bench/cache_bench.cpp -o cache_bench
+ *
+ * Usage:
+ *   cache_bench [--trace FILE | --binary-trace FILE | --workload NAME]
+ *               [--capacity N] [--length N] [--universe N] [--k LIST]
+ *               [--slru-protected RATIO] [--lruk-ghosts RATIO] [--lruk-crp N]
+ *               [--lrfu-lambda LIST] [--serial] [--save-trace FILE]
+ *
+ *   NAME is one of: zipf, scan, loop, hotspot (default: zipf).
+ *   LIST is a comma separated list of K values for LRU-K (default: 2,3).
+ *   RATIO is the share of capacity protected in SLRU (default: 0.8).
+ *   --lruk-ghosts and --lruk-crp add LRU-K variants that retain the histories
+ *   of RATIO * capacity evicted keys and merge accesses within N ticks
+ *   (defaults: 1.0 and 0; a ratio of 0 drops the variants).
+ *   --lrfu-lambda lists LRFU decay rates per simulated second, where every
+ *   access advances the clock by 1 ms (default: 0.01,0.1,1).
+ *   Policies run in parallel threads on the same trace unless --serial is given.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cache_simulator.hpp"
+
+/* ------------------------------------------------------------------------ */
+/*                   Per-thread heap accounting for the probe               */
+/* ------------------------------------------------------------------------ */
+
+namespace {
+
+thread_local long long tls_heap_bytes = 0;
+
+// Every block carries its size in a header so operator delete can account for it.
+constexpr size_t kHeader = alignof(std::max_align_t);
+
+void* CountedAlloc(size_t size) {
+    void* raw = std::malloc(size + kHeader);
+    if (raw == nullptr) throw std::bad_alloc();
+    *static_cast<size_t*>(raw) = size;
+    tls_heap_bytes += static_cast<long long>(size);
+    return static_cast<char*>(raw) + kHeader;
+}
+
+void CountedFree(void* ptr) noexcept {
+    if (ptr == nullptr) return;
+    void* raw = static_cast<char*>(ptr) - kHeader;
+    tls_heap_bytes -= static_cast<long long>(*static_cast<size_t*>(raw));
+    std::free(raw);
+}
+
+} // namespace
+
+void* operator new(size_t size) { return CountedAlloc(size); }
+void* operator new[](size_t size) { return CountedAlloc(size); }
+void operator delete(void* ptr) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { CountedFree(ptr); }
+
+/* ------------------------------------------------------------------------ */
+/*                                  Driver                                  */
+/* ------------------------------------------------------------------------ */
+
+using namespace Collections::Simulation;
+
+namespace {
+
+struct Options {
+    std::string text_trace;
+    std::string binary_trace;
+    std::string save_trace;
+    std::string workload = "zipf";
+    size_t capacity = 10000;
+    size_t length = 2000000;
+    size_t universe = 100000;
+    std::vector<size_t> ks = {2, 3};
+    double protected_ratio = 0.8;
+    double lruk_ghost_ratio = 1.0;
+    uint64_t lruk_correlated_period = 0;
+    std::vector<double> lrfu_lambdas = {0.01, 0.1, 1.0};
+    bool serial = false;
+};
+
+[[noreturn]] void Usage(const char* argv0) {
+    std::cerr << "usage: " << argv0
+              << " [--trace FILE | --binary-trace FILE | --workload zipf|scan|loop|hotspot]\n"
+                 "       [--capacity N] [--length N] [--universe N] [--k 2,3]"
+                 " [--slru-protected 0.8]\n"
+                 "       [--lruk-ghosts 1.0] [--lruk-crp 0] [--lrfu-lambda 0.01,0.1,1] [--serial]"
+                 " [--save-trace FILE]\n";
+    std::exit(2);
+}
+
+std::vector<size_t> ParseList(const std::string& text) {
+    std::vector<size_t> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) values.push_back(std::stoull(item));
+    return values;
+}
+
+std::vector<double> ParseDoubles(const std::string& text) {
+    std::vector<double> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) values.push_back(std::stod(item));
+    return values;
+}
+
+Options ParseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) Usage(argv[0]);
+            return argv[++i];
+        };
+        if (arg == "--trace") options.text_trace = next();
+        else if (arg == "--binary-trace") options.binary_trace = next();
+        else if (arg == "--save-trace") options.save_trace = next();
+        else if (arg == "--workload") options.workload = next();
+        else if (arg == "--capacity") options.capacity = std::stoull(next());
+        else if (arg == "--length") options.length = std::stoull(next());
+        else if (arg == "--universe") options.universe = std::stoull(next());
+        else if (arg == "--k") options.ks = ParseList(next());
+        else if (arg == "--slru-protected") options.protected_ratio = std::stod(next());
+        else if (arg == "--lruk-ghosts") options.lruk_ghost_ratio = std::stod(next());
+        else if (arg == "--lruk-crp") options.lruk_correlated_period = std::stoull(next());
+        else if (arg == "--lrfu-lambda") options.lrfu_lambdas = ParseDoubles(next());
+        else if (arg == "--serial") options.serial = true;
+        else Usage(argv[0]);
+    }
+    return options;
+}
+
+Trace BuildTrace(const Options& options) {
+    if (!options.text_trace.empty()) return LoadTextTrace(options.text_trace);
+    if (!options.binary_trace.empty()) return LoadBinaryTrace(options.binary_trace);
+
+    if (options.workload == "zipf")
+        return ZipfTrace(options.length, options.universe, 0.99);
+    if (options.workload == "scan")
+        return ScanTrace(options.length);
+    if (options.workload == "loop")
+        return LoopTrace(options.length, options.capacity + options.capacity / 10);
+    if (options.workload == "hotspot")
+        return ShiftingHotspotTrace(options.length, options.universe, options.capacity / 2,
+                                    options.length / 10);
+    throw std::invalid_argument("Unknown workload: " + options.workload);
+}
+
+std::vector<PolicySpec> BuildPolicies(const Options& options) {
+    std::vector<PolicySpec> specs = {LRUPolicySpec(), FixedLRUPolicySpec()};
+    for (size_t k : options.ks) specs.push_back(LRUKPolicySpec(k));
+    if (options.lruk_ghost_ratio > 0.0) {
+        for (size_t k : options.ks)
+            specs.push_back(LRUKRetainedPolicySpec(k, options.lruk_ghost_ratio, options.lruk_correlated_period));
+    }
+    for (double lambda : options.lrfu_lambdas) specs.push_back(LRFUPolicySpec(lambda));
+    specs.push_back(FrontEndPolicySpec<Collections::LRUPolicy>("Cache<LRU>"));
+    specs.push_back(FrontEndPolicySpec<Collections::LRUPolicy, Collections::FlatIndex>("Cache<LRU,F>"));
+    specs.push_back(FrontEndPolicySpec<Collections::ClockPolicy>("Cache<CLOCK>"));
+    specs.push_back(FrontEndPolicySpec("Cache<SLRU>", Collections::SLRUPolicy{options.protected_ratio}));
+    specs.push_back(FrontEndPolicySpec<Collections::LRUKPolicy<2>>("Cache<LRU-2>"));
+    return specs;
+}
+
+void Report(const std::vector<SimulationResult>& results) {
+    std::printf("%-12s %12s %10s %14s %12s %14s\n", "policy", "accesses", "hit%", "ops/s",
+                "resident", "bytes/entry");
+    for (const SimulationResult& r : results) {
+        std::printf("%-12s %12zu %9.2f%% %14.0f %12zu %14.1f\n", r.policy.c_str(), r.accesses,
+                    100.0 * r.HitRatio(), r.OpsPerSecond(), r.resident, r.BytesPerEntry());
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options = ParseOptions(argc, argv);
+    try {
+        Trace trace = BuildTrace(options);
+        if (!options.save_trace.empty()) SaveBinaryTrace(trace, options.save_trace);
+
+        std::vector<PolicySpec> specs = BuildPolicies(options);
+        HeapProbe probe = [] { return tls_heap_bytes; };
+
+        std::vector<SimulationResult> results;
+        if (options.serial) {
+            for (const PolicySpec& spec : specs)
+                results.push_back(RunTrace(spec, trace, options.capacity, probe));
+        } else {
+            results = RunParallel(specs, trace, options.capacity, probe);
+        }
+
+        std::printf("trace: %zu accesses, capacity: %zu\n", trace.size(), options.capacity);
+        Report(results);
+    } catch (const std::exception& error) {
+        std::cerr << "cache_bench: " << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
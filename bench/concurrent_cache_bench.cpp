@@ -0,0 +1,163 @@
+/**
+ * @file concurrent_cache_bench.cpp
+ * @brief Measures read throughput of the concurrent caches as threads are added.
+ *
+ * Each concurrent cache runs next to a single-mutex wrapper around its
+ * sequential counterpart: LRUCache for ConcurrentLRUCache and LRU_K_Cache
+ * for StripedLRUKCache.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -pthread -Isrc bench/concurrent_cache_bench.cpp -o concurrent_cache_bench
+ *
+ * Usage:
+ *   concurrent_cache_bench [--threads N] [--seconds S] [--keys N]
+ *
+ *   Runs 1, 2, 4, ... N reader threads. --keys 1 (the default) makes every
+ *   read hit the same hot key; larger values spread reads uniformly.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrent_lru_cache.hpp"
+#include "lru_cache.hpp"
+#include "lru_k_replacer.hpp"
+#include "striped_lru_k_cache.hpp"
+
+namespace {
+
+using Key = uint64_t;
+using Value = uint64_t;
+
+/** @brief Type-erased read and write operations of one cache under test. */
+struct Target {
+    std::string name;
+    std::function<bool(Key)> get;
+    std::function<void(Key, Value)> put;
+};
+
+Target MakeMutexLRU(size_t capacity) {
+    auto cache = std::make_shared<Collections::LRUCache<Key, Value>>(static_cast<int>(capacity));
+    auto lock = std::make_shared<std::mutex>();
+    return {"mutex LRUCache",
+            [cache, lock](Key key) {
+                std::lock_guard<std::mutex> guard(*lock);
+                return cache->get(key).has_value();
+            },
+            [cache, lock](Key key, Value value) {
+                std::lock_guard<std::mutex> guard(*lock);
+                cache->put(key, value);
+            }};
+}
+
+Target MakeConcurrentLRU(size_t capacity) {
+    auto cache = std::make_shared<Collections::ConcurrentLRUCache<Key, Value>>(capacity);
+    return {"ConcurrentLRUCache",
+            [cache](Key key) { return cache->get(key).has_value(); },
+            [cache](Key key, Value value) { cache->put(key, value); }};
+}
+
+Target MakeMutexLRUK(size_t capacity) {
+    auto cache = std::make_shared<Collections::LRU_K_Cache<Key, Value, 2>>(capacity);
+    auto lock = std::make_shared<std::mutex>();
+    return {"mutex LRU_K_Cache",
+            [cache, lock](Key key) {
+                std::lock_guard<std::mutex> guard(*lock);
+                return cache->Get(key).has_value();
+            },
+            [cache, lock](Key key, Value value) {
+                std::lock_guard<std::mutex> guard(*lock);
+                cache->Put(std::move(key), std::move(value));
+            }};
+}
+
+Target MakeStripedLRUK(size_t capacity) {
+    auto cache = std::make_shared<Collections::StripedLRUKCache<Key, Value, 2>>(capacity);
+    return {"StripedLRUKCache",
+            [cache](Key key) { return cache->Get(key).has_value(); },
+            [cache](Key key, Value value) { cache->Put(key, value); }};
+}
+
+/**
+ * @brief Runs `threads` readers for `seconds` and returns total reads per second.
+ */
+double MeasureReads(const Target& target, size_t threads, double seconds, size_t keys) {
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> counts(threads * 8, 0);  // padded per thread
+    std::vector<std::thread> workers;
+
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            uint64_t state = 0x9E3779B97F4A7C15ULL * (t + 1);
+            uint64_t reads = 0;
+            while (!start.load(std::memory_order_acquire)) {}
+            while (!stop.load(std::memory_order_relaxed)) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                target.get(keys == 1 ? 0 : state % keys);
+                ++reads;
+            }
+            counts[t * 8] = reads;
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true, std::memory_order_relaxed);
+    for (std::thread& worker : workers) worker.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    uint64_t total = 0;
+    for (size_t t = 0; t < threads; ++t) total += counts[t * 8];
+    return total / elapsed;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    double seconds = 1.0;
+    size_t keys = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "usage: " << argv[0] << " [--threads N] [--seconds S] [--keys N]\n";
+            return 2;
+        }
+        if (arg == "--threads") max_threads = std::stoull(argv[++i]);
+        else if (arg == "--seconds") seconds = std::stod(argv[++i]);
+        else if (arg == "--keys") keys = std::stoull(argv[++i]);
+        else {
+            std::cerr << "unknown option " << arg << "\n";
+            return 2;
+        }
+    }
+
+    const size_t capacity = std::max<size_t>(keys, 1024);
+    std::vector<Target> targets = {MakeMutexLRU(capacity), MakeConcurrentLRU(capacity),
+                                   MakeMutexLRUK(capacity), MakeStripedLRUK(capacity)};
+
+    std::printf("%-22s %8s %16s %10s\n", "cache", "threads", "reads/s", "scaling");
+    for (const Target& target : targets) {
+        for (Key key = 0; key < keys; ++key) target.put(key, key);
+        double single = 0.0;
+        for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+            double rate = MeasureReads(target, threads, seconds, keys);
+            if (threads == 1) single = rate;
+            std::printf("%-22s %8zu %16.0f %9.2fx\n", target.name.c_str(), threads, rate, rate / single);
+        }
+    }
+    return 0;
+}
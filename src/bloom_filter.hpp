@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file bloom_filter.hpp
+ * @brief Bloom filter for approximate set membership.
+ */
+
+namespace Collections {
+
+/**
+ * @brief A Bloom filter: possibly_contains() never returns false for an
+ *        inserted key and returns true for an absent key with a bounded
+ *        false positive rate.
+ *
+ * The k probe positions are derived from one hash by double hashing
+ * (h1 + i * h2), after a 64-bit finalizer so identity hashes such as
+ * std::hash<uint64_t> still spread across the bit array.
+ *
+ * @tparam T Element type.
+ * @tparam Hash Hash functor for T.
+ */
+template <typename T, typename Hash = std::hash<T>>
+class BloomFilter {
+private:
+    std::vector<uint64_t> words_;
+    size_t bit_count_;
+    size_t hash_count_;
+    size_t inserted_ = 0;
+    Hash hasher_;
+
+    static uint64_t Mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    template <typename Visit>
+    bool Probe(const T& value, Visit visit) const {
+        uint64_t h = Mix(hasher_(value));
+        uint64_t h1 = h;
+        uint64_t h2 = (h >> 32) | (h << 32) | 1;
+        for (size_t i = 0; i < hash_count_; ++i) {
+            uint64_t bit = (h1 + i * h2) % bit_count_;
+            if (!visit(bit / 64, uint64_t{1} << (bit % 64))) return false;
+        }
+        return true;
+    }
+
+public:
+    /**
+     * @brief Sizes the filter for an expected number of keys and a target
+     *        false positive rate.
+     *
+     * @param expected_items Number of keys the filter is sized for.
+     * @param false_positive_rate Target rate in (0, 1).
+     * @throws std::invalid_argument on a zero size or a rate outside (0, 1).
+     */
+    BloomFilter(size_t expected_items, double false_positive_rate, Hash hasher = Hash())
+        : hasher_(std::move(hasher)) {
+        if (expected_items == 0) throw std::invalid_argument("BloomFilter needs a positive expected size");
+        if (!(false_positive_rate > 0.0 && false_positive_rate < 1.0))
+            throw std::invalid_argument("BloomFilter false positive rate must be in (0, 1)");
+        const double ln2 = std::log(2.0);
+        double bits = -static_cast<double>(expected_items) * std::log(false_positive_rate) / (ln2 * ln2);
+        bit_count_ = std::max<size_t>(64, static_cast<size_t>(std::ceil(bits)));
+        hash_count_ = std::max<size_t>(1, static_cast<size_t>(std::round(bits / expected_items * ln2)));
+        words_.assign((bit_count_ + 63) / 64, 0);
+    }
+
+    void insert(const T& value) {
+        Probe(value, [this](size_t word, uint64_t mask) {
+            words_[word] |= mask;
+            return true;
+        });
+        ++inserted_;
+    }
+
+    /**
+     * @brief False means the value was definitely never inserted.
+     */
+    bool possibly_contains(const T& value) const {
+        return Probe(value, [this](size_t word, uint64_t mask) { return (words_[word] & mask) != 0; });
+    }
+
+    void clear() {
+        std::fill(words_.begin(), words_.end(), 0);
+        inserted_ = 0;
+    }
+
+    /**
+     * @brief Expected false positive rate given the insertions so far.
+     */
+    double estimated_false_positive_rate() const {
+        double fill = 1.0 - std::exp(-static_cast<double>(hash_count_) * inserted_ / bit_count_);
+        return std::pow(fill, static_cast<double>(hash_count_));
+    }
+
+    size_t bit_count() const { return bit_count_; }
+
+    size_t hash_count() const { return hash_count_; }
+
+    size_t inserted() const { return inserted_; }
+};
+
+} // namespace Collections
@@ -0,0 +1,753 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include "vector.hpp"
+
+/**
+ * @file btree_map.hpp
+ * @brief In-memory B+-tree ordered map with cache-line sized nodes.
+ */
+
+namespace Collections {
+
+namespace detail {
+
+/**
+ * @brief Counts keys[i] < key (or <= key if Inclusive) in a sorted node.
+ *
+ * Arithmetic keys are compared several at a time with SSE2 (SSE4.2 for
+ * 64-bit integers): on nodes a few cache lines long, a branch-free linear
+ * count beats binary search. Other types fall back to a scalar count.
+ */
+template <bool Inclusive, typename K>
+size_t CountBelow(const K* keys, size_t n, K key) {
+    size_t count = 0;
+    size_t i = 0;
+#if defined(__SSE2__)
+    if constexpr (std::is_same_v<K, float>) {
+        __m128 k = _mm_set1_ps(key);
+        for (; i + 4 <= n; i += 4) {
+            __m128 v = _mm_loadu_ps(keys + i);
+            count += std::popcount(static_cast<unsigned>(
+                _mm_movemask_ps(Inclusive ? _mm_cmple_ps(v, k) : _mm_cmplt_ps(v, k))));
+        }
+    } else if constexpr (std::is_same_v<K, double>) {
+        __m128d k = _mm_set1_pd(key);
+        for (; i + 2 <= n; i += 2) {
+            __m128d v = _mm_loadu_pd(keys + i);
+            count += std::popcount(static_cast<unsigned>(
+                _mm_movemask_pd(Inclusive ? _mm_cmple_pd(v, k) : _mm_cmplt_pd(v, k))));
+        }
+    } else if constexpr (std::is_integral_v<K> && sizeof(K) == 4) {
+        // Unsigned keys are biased into signed order.
+        const __m128i bias = _mm_set1_epi32(std::is_signed_v<K> ? 0 : INT32_MIN);
+        __m128i k = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(key)), bias);
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), bias);
+            // v <= k is !(v > k); v < k is k > v.
+            __m128i mask = Inclusive ? _mm_cmpgt_epi32(v, k) : _mm_cmpgt_epi32(k, v);
+            unsigned bits = std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(mask))));
+            count += Inclusive ? 4 - bits : bits;
+        }
+    }
+#if defined(__SSE4_2__)
+    else if constexpr (std::is_integral_v<K> && sizeof(K) == 8) {
+        const __m128i bias = _mm_set1_epi64x(std::is_signed_v<K> ? 0 : INT64_MIN);
+        __m128i k = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(key)), bias);
+        for (; i + 2 <= n; i += 2) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), bias);
+            __m128i mask = Inclusive ? _mm_cmpgt_epi64(v, k) : _mm_cmpgt_epi64(k, v);
+            unsigned bits = std::popcount(static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(mask))));
+            count += Inclusive ? 2 - bits : bits;
+        }
+    }
+#endif
+#endif
+    for (; i < n; ++i) count += Inclusive ? !(key < keys[i]) : keys[i] < key;
+    return count;
+}
+
+} // namespace detail
+
+/**
+ * @brief An ordered map stored as a B+-tree.
+ *
+ * Each node holds up to kSlots keys in a contiguous array, sized so that
+ * the node header and the keys together fill kNodeCacheLines cache lines. A
+ * node visit therefore touches a few adjacent lines instead of one
+ * scattered node per level as in a red-black tree. Values
+ * live only in the leaves. The leaves are chained in key order, so range
+ * iteration walks arrays leaf by leaf.
+ *
+ * With arithmetic keys and std::less, in-node search is a SIMD count of
+ * smaller keys (see detail::CountBelow); otherwise it is a binary search
+ * with Compare.
+ *
+ * A leaf that overflows splits in half. When the insertion is past the last
+ * key of the rightmost leaf, the split instead starts a new leaf with just
+ * that key. Appending ascending keys, as a time-series index does, then
+ * leaves full leaves behind. Erase frees a node when it becomes empty and
+ * never merges underfull ones ("free-at-empty"), which keeps erase simple
+ * and costs little space under mixed workloads.
+ *
+ * Copies are rebuilt bottom up like bulk_load(), so a copied tree has full
+ * leaves whatever the shape of the original.
+ *
+ * Insertion may move entries between leaves, so it invalidates iterators;
+ * erase invalidates iterators into the affected leaf. Not thread-safe; an
+ * optimistic lock-coupling concurrent variant is not part of this class.
+ *
+ * @tparam K Key type; default-constructible and copyable.
+ * @tparam V Mapped type; default-constructible and movable (copyable to copy the map).
+ * @tparam Compare Strict weak ordering of keys.
+ */
+template <typename K, typename V, typename Compare = std::less<K>>
+class BTreeMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using size_type = size_t;
+    using key_compare = Compare;
+
+    static constexpr size_t kCacheLineSize = 64;
+    static constexpr size_t kNodeCacheLines = 4;
+
+private:
+    /** @brief Bytes before the keys: count_ and leaf_, padded to the key alignment. */
+    static constexpr size_t kHeaderSize = std::max(sizeof(uint64_t), alignof(K));
+
+public:
+    /** @brief Keys per node. */
+    static constexpr size_t kSlots =
+        std::max<size_t>(4, (kNodeCacheLines * kCacheLineSize - kHeaderSize) / sizeof(K));
+
+private:
+    static constexpr bool kSimdSearch =
+        std::is_arithmetic_v<K> && (std::is_same_v<Compare, std::less<K>> || std::is_same_v<Compare, std::less<>>);
+
+    /** @brief The header shares the first cache line with the keys. */
+    struct alignas(kCacheLineSize) Node {
+        uint32_t count_ = 0;  ///< Keys in use.
+        bool leaf_;
+        K keys_[kSlots];
+
+        explicit Node(bool leaf) : leaf_(leaf) {}
+    };
+
+    static_assert(!std::is_arithmetic_v<K> || sizeof(Node) == kNodeCacheLines * kCacheLineSize);
+
+    struct Leaf : Node {
+        V values_[kSlots];
+        Leaf* prev_ = nullptr;
+        Leaf* next_ = nullptr;
+
+        Leaf() : Node(true) {}
+    };
+
+    /** @brief children_[i] holds keys k with keys_[i - 1] <= k < keys_[i]. */
+    struct Inner : Node {
+        Node* children_[kSlots + 1];
+
+        Inner() : Node(false) {}
+    };
+
+    Node* root_ = nullptr;
+    Leaf* head_ = nullptr;  ///< Leftmost leaf.
+    size_t size_ = 0;
+    size_t height_ = 0;     ///< Levels, 0 when empty.
+    [[no_unique_address]] Compare less_;
+
+    /** @brief Index of the first key not less than `key`. */
+    size_t LowerBound(const Node* node, const K& key) const {
+        if constexpr (kSimdSearch) {
+            return detail::CountBelow<false>(node->keys_, node->count_, key);
+        } else {
+            return std::lower_bound(node->keys_, node->keys_ + node->count_, key, less_) - node->keys_;
+        }
+    }
+
+    /** @brief Index of the first key greater than `key`; the child to descend into. */
+    size_t UpperBound(const Node* node, const K& key) const {
+        if constexpr (kSimdSearch) {
+            return detail::CountBelow<true>(node->keys_, node->count_, key);
+        } else {
+            return std::upper_bound(node->keys_, node->keys_ + node->count_, key, less_) - node->keys_;
+        }
+    }
+
+    bool Equal(const K& a, const K& b) const { return !less_(a, b) && !less_(b, a); }
+
+    Leaf* FindLeaf(const K& key) const {
+        Node* node = root_;
+        while (!node->leaf_) {
+            const Inner* inner = static_cast<const Inner*>(node);
+            node = inner->children_[UpperBound(inner, key)];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    /** @brief Frees one node, not its children. */
+    static void Free(Node* node) {
+        if (node->leaf_) delete static_cast<Leaf*>(node);
+        else delete static_cast<Inner*>(node);
+    }
+
+    void Destroy(Node* node) {
+        if (!node->leaf_) {
+            const Inner* inner = static_cast<const Inner*>(node);
+            for (size_t i = 0; i <= inner->count_; ++i) Destroy(inner->children_[i]);
+        }
+        Free(node);
+    }
+
+    /** @brief A split node handed up to the parent: its lowest bound and itself. */
+    struct Split {
+        K key;
+        Node* node = nullptr;
+    };
+
+    /** @brief Where an insertion landed. */
+    struct Position {
+        Leaf* leaf;
+        size_t index;
+        bool inserted;
+    };
+
+    template <typename M>
+    Position InsertIntoLeaf(Leaf* leaf, const K& key, M&& value, bool assign, Split& split) {
+        size_t index = LowerBound(leaf, key);
+        if (index < leaf->count_ && Equal(leaf->keys_[index], key)) {
+            if (assign) leaf->values_[index] = std::forward<M>(value);
+            return {leaf, index, false};
+        }
+        if (leaf->count_ < kSlots) {
+            PlaceInLeaf(leaf, index, key, std::forward<M>(value));
+            return {leaf, index, true};
+        }
+
+        Leaf* right = new Leaf();
+        right->prev_ = leaf;
+        right->next_ = leaf->next_;
+        if (leaf->next_ != nullptr) leaf->next_->prev_ = right;
+        leaf->next_ = right;
+        split.node = right;
+
+        if (index == kSlots && right->next_ == nullptr) {  // append: keep the left leaf full
+            PlaceInLeaf(right, 0, key, std::forward<M>(value));
+            split.key = key;
+            return {right, 0, true};
+        }
+        size_t mid = kSlots / 2;
+        for (size_t i = mid; i < kSlots; ++i) {
+            right->keys_[i - mid] = std::move(leaf->keys_[i]);
+            right->values_[i - mid] = std::move(leaf->values_[i]);
+            leaf->values_[i] = V();
+        }
+        right->count_ = static_cast<uint32_t>(kSlots - mid);
+        leaf->count_ = static_cast<uint32_t>(mid);
+        split.key = right->keys_[0];
+        if (index <= mid) {
+            PlaceInLeaf(leaf, index, key, std::forward<M>(value));
+            return {leaf, index, true};
+        }
+        PlaceInLeaf(right, index - mid, key, std::forward<M>(value));
+        return {right, index - mid, true};
+    }
+
+    template <typename M>
+    static void PlaceInLeaf(Leaf* leaf, size_t index, const K& key, M&& value) {
+        for (size_t i = leaf->count_; i > index; --i) {
+            leaf->keys_[i] = std::move(leaf->keys_[i - 1]);
+            leaf->values_[i] = std::move(leaf->values_[i - 1]);
+        }
+        leaf->keys_[index] = key;
+        leaf->values_[index] = std::forward<M>(value);
+        leaf->count_++;
+    }
+
+    /** @brief Adds child `split.node` after children_[index], splitting the node if full. */
+    void InsertIntoInner(Inner* inner, size_t index, const Split& child, Split& split) {
+        if (inner->count_ < kSlots) {
+            for (size_t i = inner->count_; i > index; --i) {
+                inner->keys_[i] = std::move(inner->keys_[i - 1]);
+                inner->children_[i + 1] = inner->children_[i];
+            }
+            inner->keys_[index] = child.key;
+            inner->children_[index + 1] = child.node;
+            inner->count_++;
+            return;
+        }
+
+        // Lay out all kSlots + 1 keys and kSlots + 2 children, then cut in two.
+        K keys[kSlots + 1];
+        Node* children[kSlots + 2];
+        for (size_t i = 0, j = 0; i <= kSlots; ++i) keys[i] = i == index ? child.key : std::move(inner->keys_[j++]);
+        for (size_t i = 0, j = 0; i <= kSlots + 1; ++i) {
+            children[i] = i == index + 1 ? child.node : inner->children_[j++];
+        }
+
+        size_t mid = (kSlots + 1) / 2;  // keys[mid] moves up
+        Inner* right = new Inner();
+        inner->count_ = static_cast<uint32_t>(mid);
+        for (size_t i = 0; i < mid; ++i) inner->keys_[i] = std::move(keys[i]);
+        for (size_t i = 0; i <= mid; ++i) inner->children_[i] = children[i];
+        right->count_ = static_cast<uint32_t>(kSlots - mid);
+        for (size_t i = mid + 1; i <= kSlots; ++i) right->keys_[i - mid - 1] = std::move(keys[i]);
+        for (size_t i = mid + 1; i <= kSlots + 1; ++i) right->children_[i - mid - 1] = children[i];
+        split.key = std::move(keys[mid]);
+        split.node = right;
+    }
+
+    template <typename M>
+    Position InsertInto(Node* node, const K& key, M&& value, bool assign, Split& split) {
+        if (node->leaf_) return InsertIntoLeaf(static_cast<Leaf*>(node), key, std::forward<M>(value), assign, split);
+        Inner* inner = static_cast<Inner*>(node);
+        size_t index = UpperBound(inner, key);
+        Split child;
+        Position position = InsertInto(inner->children_[index], key, std::forward<M>(value), assign, child);
+        if (child.node != nullptr) InsertIntoInner(inner, index, child, split);
+        return position;
+    }
+
+    template <typename M>
+    Position Insert(const K& key, M&& value, bool assign) {
+        if (root_ == nullptr) {
+            head_ = new Leaf();
+            root_ = head_;
+            height_ = 1;
+        }
+        Split split;
+        Position position = InsertInto(root_, key, std::forward<M>(value), assign, split);
+        if (split.node != nullptr) {
+            Inner* root = new Inner();
+            root->count_ = 1;
+            root->keys_[0] = std::move(split.key);
+            root->children_[0] = root_;
+            root->children_[1] = split.node;
+            root_ = root;
+            height_++;
+        }
+        if (position.inserted) size_++;
+        return position;
+    }
+
+    /**
+     * @brief Removes `key` below `node`; sets `emptied` if `node` has no keys left.
+     */
+    bool EraseFrom(Node* node, const K& key, bool& emptied) {
+        if (node->leaf_) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            size_t index = LowerBound(leaf, key);
+            if (index == leaf->count_ || !Equal(leaf->keys_[index], key)) return false;
+            for (size_t i = index + 1; i < leaf->count_; ++i) {
+                leaf->keys_[i - 1] = std::move(leaf->keys_[i]);
+                leaf->values_[i - 1] = std::move(leaf->values_[i]);
+            }
+            leaf->count_--;
+            leaf->keys_[leaf->count_] = K();
+            leaf->values_[leaf->count_] = V();
+            if (leaf->count_ == 0) {
+                if (leaf->prev_ != nullptr) leaf->prev_->next_ = leaf->next_;
+                else head_ = leaf->next_;
+                if (leaf->next_ != nullptr) leaf->next_->prev_ = leaf->prev_;
+                emptied = true;
+            }
+            return true;
+        }
+
+        Inner* inner = static_cast<Inner*>(node);
+        size_t index = UpperBound(inner, key);
+        bool child_emptied = false;
+        if (!EraseFrom(inner->children_[index], key, child_emptied)) return false;
+        if (child_emptied) {
+            Free(inner->children_[index]);  // an emptied inner node has freed its own child
+            if (inner->count_ == 0) {  // that was the only child
+                emptied = true;
+                return true;
+            }
+            // Drop the separator on the side of the removed child; the
+            // neighbouring child's range grows to cover it.
+            size_t separator = index == 0 ? 0 : index - 1;
+            for (size_t i = separator + 1; i < inner->count_; ++i) inner->keys_[i - 1] = std::move(inner->keys_[i]);
+            for (size_t i = index + 1; i <= inner->count_; ++i) inner->children_[i - 1] = inner->children_[i];
+            inner->count_--;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Builds the tree bottom up from `n` entries in increasing key order.
+     *
+     * Leaves are filled completely and every level is built in one pass.
+     * `next(key, value)` assigns the next entry. The tree must be empty. If
+     * `next` or an allocation throws, the nodes built so far are freed and
+     * the tree stays empty.
+     */
+    template <typename Next>
+    void Build(size_t n, Next next) {
+        if (n == 0) return;
+        std::vector<Node*> level;
+        std::vector<K> lows;  // lowest key under each node of `level`
+        std::vector<Inner*> inners;
+        try {
+            Leaf* previous = nullptr;
+            for (size_t start = 0; start < n; start += kSlots) {
+                Leaf* leaf = new Leaf();
+                leaf->prev_ = previous;
+                if (previous != nullptr) previous->next_ = leaf;
+                else head_ = leaf;
+                previous = leaf;
+                size_t count = std::min(kSlots, n - start);
+                for (size_t i = 0; i < count; ++i) next(leaf->keys_[i], leaf->values_[i]);
+                leaf->count_ = static_cast<uint32_t>(count);
+                level.push_back(leaf);
+                lows.push_back(leaf->keys_[0]);
+            }
+
+            size_t height = 1;
+            while (level.size() > 1) {
+                std::vector<Node*> parents;
+                std::vector<K> parent_lows;
+                for (size_t start = 0, count = 0; start < level.size(); start += count) {
+                    size_t remaining = level.size() - start;
+                    count = std::min(kSlots + 1, remaining);
+                    // Never leave one child for a keyless last parent; split the last two evenly.
+                    if (remaining - count == 1) count = remaining / 2;
+                    inners.push_back(nullptr);
+                    Inner* inner = inners.back() = new Inner();
+                    for (size_t i = 0; i < count; ++i) {
+                        inner->children_[i] = level[start + i];
+                        if (i > 0) inner->keys_[i - 1] = lows[start + i];
+                    }
+                    inner->count_ = static_cast<uint32_t>(count - 1);
+                    parents.push_back(inner);
+                    parent_lows.push_back(lows[start]);
+                }
+                level = std::move(parents);
+                lows = std::move(parent_lows);
+                height++;
+            }
+            root_ = level.front();
+            size_ = n;
+            height_ = height;
+        } catch (...) {
+            for (Inner* inner : inners) delete inner;
+            while (head_ != nullptr) delete std::exchange(head_, head_->next_);
+            throw;
+        }
+    }
+
+public:
+    /**
+     * @brief Forward iterator over (key, value) pairs in key order.
+     *
+     * Dereferences to a pair of references, so `auto [key, value] = *it`
+     * binds to the stored entry.
+     */
+    template <bool Const>
+    class Iterator {
+    private:
+        friend class BTreeMap;
+        friend class Iterator<!Const>;
+
+        using LeafPtr = std::conditional_t<Const, const Leaf*, Leaf*>;
+        using ValueRef = std::conditional_t<Const, const V&, V&>;
+
+        LeafPtr leaf_ = nullptr;
+        size_t index_ = 0;
+
+        Iterator(LeafPtr leaf, size_t index) : leaf_(leaf), index_(index) {
+            if (leaf_ != nullptr && index_ == leaf_->count_) {
+                leaf_ = leaf_->next_;
+                index_ = 0;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, V>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K&, ValueRef>;
+
+        Iterator() = default;
+
+        template <bool OtherConst>
+            requires(Const && !OtherConst)
+        Iterator(const Iterator<OtherConst>& other) : leaf_(other.leaf_), index_(other.index_) {}
+
+        const K& key() const { return leaf_->keys_[index_]; }
+        ValueRef value() const { return leaf_->values_[index_]; }
+        reference operator*() const { return {key(), value()}; }
+
+        Iterator& operator++() {
+            if (++index_ == leaf_->count_) {
+                leaf_ = leaf_->next_;
+                index_ = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) {
+            return a.leaf_ == b.leaf_ && a.index_ == b.index_;
+        }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    /**
+     * @brief A half-open key range [first, last) usable in range-for.
+     */
+    template <typename It>
+    struct Range {
+        It first;
+        It last;
+
+        It begin() const { return first; }
+        It end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    BTreeMap() = default;
+
+    explicit BTreeMap(const Compare& less) : less_(less) {}
+
+    /**
+     * @brief Builds the tree from sorted, unique keys; see bulk_load().
+     */
+    BTreeMap(const Vector<K>& keys, const Vector<V>& values, const Compare& less = Compare()) : less_(less) {
+        bulk_load(keys, values);
+    }
+
+    /**
+     * @brief Copies the entries of `other` into a freshly bulk-built tree.
+     */
+    BTreeMap(const BTreeMap& other) : less_(other.less_) {
+        const Leaf* leaf = other.head_;
+        size_t index = 0;
+        Build(other.size_, [&](K& key, V& value) {
+            key = leaf->keys_[index];
+            value = leaf->values_[index];
+            if (++index == leaf->count_) {
+                leaf = leaf->next_;
+                index = 0;
+            }
+        });
+    }
+
+    BTreeMap& operator=(const BTreeMap& other) {
+        if (this != &other) *this = BTreeMap(other);
+        return *this;
+    }
+
+    BTreeMap(BTreeMap&& other) noexcept
+        : root_(std::exchange(other.root_, nullptr)),
+          head_(std::exchange(other.head_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          height_(std::exchange(other.height_, 0)),
+          less_(std::move(other.less_)) {}
+
+    BTreeMap& operator=(BTreeMap&& other) noexcept {
+        if (this != &other) {
+            clear();
+            std::swap(root_, other.root_);
+            std::swap(head_, other.head_);
+            std::swap(size_, other.size_);
+            std::swap(height_, other.height_);
+            std::swap(less_, other.less_);
+        }
+        return *this;
+    }
+
+    ~BTreeMap() { clear(); }
+
+    void clear() {
+        if (root_ != nullptr) Destroy(root_);
+        root_ = nullptr;
+        head_ = nullptr;
+        size_ = 0;
+        height_ = 0;
+    }
+
+    /**
+     * @brief Replaces the contents with sorted keys and their values, bottom up.
+     *
+     * Leaves are filled completely and every level is built in one pass,
+     * which takes O(n) instead of n insertions. If copying an entry throws,
+     * the map is left empty.
+     *
+     * @param keys Keys in strictly increasing order.
+     * @param values Values, one per key.
+     * @throws std::invalid_argument If the sizes differ or the keys are not
+     *         strictly increasing.
+     */
+    void bulk_load(const Vector<K>& keys, const Vector<V>& values) {
+        size_t n = keys.size();
+        if (values.size() != n) throw std::invalid_argument("BTreeMap::bulk_load: keys and values differ in size");
+        for (size_t i = 1; i < n; ++i) {
+            if (!less_(keys[i - 1], keys[i]))
+                throw std::invalid_argument("BTreeMap::bulk_load: keys must be strictly increasing");
+        }
+        clear();
+        if (n == 0) return;
+        size_t index = 0;
+        Build(n, [&](K& key, V& value) {
+            key = keys[index];
+            value = values[index];
+            ++index;
+        });
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /** @brief Number of levels, 0 for an empty tree. */
+    size_t height() const { return height_; }
+
+    iterator begin() { return {head_, 0}; }
+    const_iterator begin() const { return {head_, 0}; }
+    iterator end() { return {}; }
+    const_iterator end() const { return {}; }
+
+    iterator find(const K& key) {
+        if (root_ == nullptr) return end();
+        Leaf* leaf = FindLeaf(key);
+        size_t index = LowerBound(leaf, key);
+        if (index < leaf->count_ && Equal(leaf->keys_[index], key)) return {leaf, index};
+        return end();
+    }
+
+    const_iterator find(const K& key) const { return const_cast<BTreeMap*>(this)->find(key); }
+
+    bool contains(const K& key) const { return find(key) != end(); }
+
+    size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    V& at(const K& key) {
+        iterator it = find(key);
+        if (it == end()) throw std::out_of_range("BTreeMap::at: key not found");
+        return it.value();
+    }
+
+    const V& at(const K& key) const { return const_cast<BTreeMap*>(this)->at(key); }
+
+    V& operator[](const K& key) {
+        Position position = Insert(key, V(), false);
+        return position.leaf->values_[position.index];
+    }
+
+    /** @brief First entry whose key is not less than `key`. */
+    iterator lower_bound(const K& key) {
+        if (root_ == nullptr) return end();
+        Leaf* leaf = FindLeaf(key);
+        return {leaf, LowerBound(leaf, key)};
+    }
+
+    const_iterator lower_bound(const K& key) const { return const_cast<BTreeMap*>(this)->lower_bound(key); }
+
+    /** @brief First entry whose key is greater than `key`. */
+    iterator upper_bound(const K& key) {
+        if (root_ == nullptr) return end();
+        Leaf* leaf = FindLeaf(key);
+        return {leaf, UpperBound(leaf, key)};
+    }
+
+    const_iterator upper_bound(const K& key) const { return const_cast<BTreeMap*>(this)->upper_bound(key); }
+
+    /**
+     * @brief Entries with low <= key < high, in key order.
+     */
+    Range<iterator> range(const K& low, const K& high) {
+        if (!less_(low, high)) return {end(), end()};
+        return {lower_bound(low), lower_bound(high)};
+    }
+
+    Range<const_iterator> range(const K& low, const K& high) const {
+        if (!less_(low, high)) return {end(), end()};
+        return {lower_bound(low), lower_bound(high)};
+    }
+
+    /**
+     * @brief Calls `visit(key, value)` for every entry with low <= key < high.
+     *
+     * Runs one tight loop per leaf instead of an iterator step per entry,
+     * which suits long scans.
+     */
+    template <typename Visit>
+    void scan(const K& low, const K& high, Visit visit) const {
+        if (root_ == nullptr || !less_(low, high)) return;
+        const Leaf* leaf = FindLeaf(low);
+        size_t index = LowerBound(leaf, low);
+        for (; leaf != nullptr; leaf = leaf->next_, index = 0) {
+            size_t stop = leaf->count_;
+            bool last = less_(leaf->keys_[stop - 1], high) == false;
+            if (last) stop = LowerBound(leaf, high);
+            for (; index < stop; ++index) visit(leaf->keys_[index], leaf->values_[index]);
+            if (last) return;
+        }
+    }
+
+    /**
+     * @brief Inserts a value unless the key exists.
+     * @return The entry and whether it was inserted.
+     */
+    std::pair<iterator, bool> insert(const K& key, V value) {
+        Position position = Insert(key, std::move(value), false);
+        return {iterator(position.leaf, position.index), position.inserted};
+    }
+
+    std::pair<iterator, bool> insert_or_assign(const K& key, V value) {
+        Position position = Insert(key, std::move(value), true);
+        return {iterator(position.leaf, position.index), position.inserted};
+    }
+
+    /**
+     * @brief Removes a key.
+     * @return The number of entries removed, 0 or 1.
+     */
+    size_t erase(const K& key) {
+        if (root_ == nullptr) return 0;
+        bool emptied = false;
+        if (!EraseFrom(root_, key, emptied)) return 0;
+        size_--;
+        if (emptied) {
+            Free(root_);
+            root_ = nullptr;
+            head_ = nullptr;
+            height_ = 0;
+            return 1;
+        }
+        while (!root_->leaf_ && root_->count_ == 0) {  // collapse single-child roots
+            Inner* old = static_cast<Inner*>(root_);
+            root_ = old->children_[0];
+            delete old;
+            height_--;
+        }
+        return 1;
+    }
+};
+
+} // namespace Collections
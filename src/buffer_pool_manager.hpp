@@ -0,0 +1,806 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "lru_k_replacer.hpp"
+
+/**
+ * @file buffer_pool_manager.hpp
+ * @brief Buffer pool over a local page file with LRU-K replacement.
+ */
+
+namespace Collections {
+
+/** @brief Index of a page in the page file. */
+using page_id_t = int64_t;
+
+/** @brief Page id of an empty frame. */
+inline constexpr page_id_t kInvalidPageId = -1;
+
+/** @brief Size of a page on disk and in memory. */
+inline constexpr size_t kPageSize = 4096;
+
+/* ------------------------------------------------------------------------ */
+/*                                Disk manager                              */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Reads and writes fixed-size pages of one file with pread/pwrite.
+ *
+ * Page i lives at byte offset i * kPageSize. Reading a page that was
+ * allocated but never written yields zeros. Page ids outside
+ * [0, NumPages()) are rejected with std::out_of_range.
+ */
+class DiskManager {
+private:
+    int fd_ = -1;
+    std::atomic<page_id_t> next_page_id_{0};
+    std::atomic<uint64_t> writes_{0};  ///< pwrite/pwritev calls issued.
+
+    [[noreturn]] static void ThrowErrno(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    off_t OffsetOf(page_id_t page_id) const {
+        CheckPageId(page_id);
+        return static_cast<off_t>(page_id) * static_cast<off_t>(kPageSize);
+    }
+
+    void WriteFully(const char* data, size_t size, off_t offset) {
+        while (size > 0) {
+            ssize_t n = pwrite(fd_, data, size, offset);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                ThrowErrno("DiskManager pwrite");
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += n;
+            writes_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    /**
+     * @brief Opens or creates the page file.
+     *
+     * @param path Page file path.
+     */
+    explicit DiskManager(const std::string& path) {
+        fd_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) ThrowErrno("DiskManager open");
+        struct stat st;
+        if (fstat(fd_, &st) != 0) {
+            close(fd_);
+            ThrowErrno("DiskManager fstat");
+        }
+        next_page_id_ = static_cast<page_id_t>((st.st_size + kPageSize - 1) / kPageSize);
+    }
+
+    DiskManager(const DiskManager&) = delete;
+    DiskManager& operator=(const DiskManager&) = delete;
+
+    ~DiskManager() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    /**
+     * @brief Reserves a new page id at the end of the file.
+     */
+    page_id_t AllocatePage() { return next_page_id_.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief Throws std::out_of_range unless `page_id` has been allocated.
+     */
+    void CheckPageId(page_id_t page_id) const {
+        if (page_id < 0 || page_id >= NumPages()) throw std::out_of_range("DiskManager: invalid page id");
+    }
+
+    /**
+     * @brief Reads one page into `data` (kPageSize bytes).
+     */
+    void ReadPage(page_id_t page_id, char* data) {
+        size_t done = 0;
+        off_t offset = OffsetOf(page_id);
+        while (done < kPageSize) {
+            ssize_t n = pread(fd_, data + done, kPageSize - done, offset + static_cast<off_t>(done));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                ThrowErrno("DiskManager pread");
+            }
+            if (n == 0) break;  // past the end of the file
+            done += static_cast<size_t>(n);
+        }
+        std::memset(data + done, 0, kPageSize - done);
+    }
+
+    /**
+     * @brief Writes one page from `data` (kPageSize bytes).
+     */
+    void WritePage(page_id_t page_id, const char* data) {
+        WriteFully(data, kPageSize, OffsetOf(page_id));
+    }
+
+    /**
+     * @brief Writes pages sorted by id; each run of consecutive ids is one pwritev().
+     *
+     * @param pages (page id, data) pairs in ascending page id order.
+     */
+    void WritePages(const std::vector<std::pair<page_id_t, const char*>>& pages) {
+        size_t begin = 0;
+        while (begin < pages.size()) {
+            size_t end = begin + 1;
+            while (end < pages.size() && end - begin < IOV_MAX &&
+                   pages[end].first == pages[end - 1].first + 1) {
+                ++end;
+            }
+
+            std::vector<iovec> iov(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                iov[i - begin] = {const_cast<char*>(pages[i].second), kPageSize};
+            }
+            off_t offset = OffsetOf(pages[begin].first);
+            CheckPageId(pages[end - 1].first);
+            ssize_t n = pwritev(fd_, iov.data(), static_cast<int>(iov.size()), offset);
+            writes_.fetch_add(1, std::memory_order_relaxed);
+            if (n != static_cast<ssize_t>(iov.size() * kPageSize)) {
+                // Short or failed vector write: finish page by page.
+                for (size_t i = begin; i < end; ++i) WritePage(pages[i].first, pages[i].second);
+            }
+            begin = end;
+        }
+    }
+
+    /**
+     * @brief Forces written pages to stable storage.
+     */
+    void Sync() {
+        if (fsync(fd_) != 0) ThrowErrno("DiskManager fsync");
+    }
+
+    /** @brief Number of pages allocated so far. */
+    page_id_t NumPages() const { return next_page_id_.load(std::memory_order_relaxed); }
+
+    /** @brief Number of write system calls issued. */
+    uint64_t NumWrites() const { return writes_.load(std::memory_order_relaxed); }
+};
+
+/* ------------------------------------------------------------------------ */
+/*                                    Pages                                 */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief A buffer pool frame and the page it currently holds.
+ *
+ * The reader-writer latch protects the page contents; the metadata is owned
+ * by the BufferPoolManager and only changed under its latch.
+ *
+ * While io_pending_ is set the frame is being read or written back with the
+ * pool latch released; it is neither pinned nor in the replacer, and lookups
+ * of its page id wait for the I/O to finish.
+ */
+class Page {
+private:
+    friend class BufferPoolManager;
+
+    alignas(64) char data_[kPageSize] = {};
+    page_id_t page_id_ = kInvalidPageId;
+    int pin_count_ = 0;
+    bool is_dirty_ = false;
+    bool io_pending_ = false;
+    std::shared_mutex rwlatch_;
+
+    void Reset() {
+        std::memset(data_, 0, kPageSize);
+        page_id_ = kInvalidPageId;
+        pin_count_ = 0;
+        is_dirty_ = false;
+        io_pending_ = false;
+    }
+
+public:
+    char* GetData() { return data_; }
+    const char* GetData() const { return data_; }
+    page_id_t GetPageId() const { return page_id_; }
+    int GetPinCount() const { return pin_count_; }
+    bool IsDirty() const { return is_dirty_; }
+
+    void RLatch() { rwlatch_.lock_shared(); }
+    void RUnlatch() { rwlatch_.unlock_shared(); }
+    bool TryRLatch() { return rwlatch_.try_lock_shared(); }
+    void WLatch() { rwlatch_.lock(); }
+    void WUnlatch() { rwlatch_.unlock(); }
+};
+
+class BufferPoolManager;
+
+/**
+ * @brief Keeps a page pinned for its lifetime and unpins it on destruction.
+ */
+class BasicPageGuard {
+private:
+    friend class ReadPageGuard;
+    friend class WritePageGuard;
+
+    BufferPoolManager* bpm_ = nullptr;
+    Page* page_ = nullptr;
+    bool is_dirty_ = false;
+
+public:
+    BasicPageGuard() = default;
+    BasicPageGuard(BufferPoolManager* bpm, Page* page) : bpm_(bpm), page_(page) {}
+
+    BasicPageGuard(const BasicPageGuard&) = delete;
+    BasicPageGuard& operator=(const BasicPageGuard&) = delete;
+
+    BasicPageGuard(BasicPageGuard&& other) noexcept
+        : bpm_(std::exchange(other.bpm_, nullptr)),
+          page_(std::exchange(other.page_, nullptr)),
+          is_dirty_(std::exchange(other.is_dirty_, false)) {}
+
+    BasicPageGuard& operator=(BasicPageGuard&& other) noexcept {
+        if (this != &other) {
+            Drop();
+            bpm_ = std::exchange(other.bpm_, nullptr);
+            page_ = std::exchange(other.page_, nullptr);
+            is_dirty_ = std::exchange(other.is_dirty_, false);
+        }
+        return *this;
+    }
+
+    ~BasicPageGuard() { Drop(); }
+
+    /**
+     * @brief Unpins the page now; the guard becomes empty.
+     */
+    inline void Drop();
+
+    explicit operator bool() const { return page_ != nullptr; }
+
+    page_id_t PageId() const { return page_->GetPageId(); }
+
+    const char* GetData() const { return page_->GetData(); }
+
+    /** @brief Mutable access; marks the page dirty. */
+    char* GetDataMut() {
+        is_dirty_ = true;
+        return page_->GetData();
+    }
+
+    template <typename T>
+    const T* As() const { return reinterpret_cast<const T*>(GetData()); }
+
+    template <typename T>
+    T* AsMut() { return reinterpret_cast<T*>(GetDataMut()); }
+};
+
+/**
+ * @brief A pinned page held under its shared latch.
+ */
+class ReadPageGuard {
+private:
+    BasicPageGuard guard_;
+
+public:
+    ReadPageGuard() = default;
+
+    /** @brief Adopts a pinned page whose shared latch is already held. */
+    ReadPageGuard(BufferPoolManager* bpm, Page* page) : guard_(bpm, page) {}
+
+    ReadPageGuard(ReadPageGuard&&) noexcept = default;
+
+    ReadPageGuard& operator=(ReadPageGuard&& other) noexcept {
+        if (this != &other) {
+            Drop();
+            guard_ = std::move(other.guard_);
+        }
+        return *this;
+    }
+
+    ~ReadPageGuard() { Drop(); }
+
+    /**
+     * @brief Releases the latch, then the pin.
+     */
+    void Drop() {
+        if (guard_.page_ != nullptr) guard_.page_->RUnlatch();
+        guard_.Drop();
+    }
+
+    explicit operator bool() const { return static_cast<bool>(guard_); }
+
+    page_id_t PageId() const { return guard_.PageId(); }
+
+    const char* GetData() const { return guard_.GetData(); }
+
+    template <typename T>
+    const T* As() const { return guard_.As<T>(); }
+};
+
+/**
+ * @brief A pinned page held under its exclusive latch; dirty on release.
+ */
+class WritePageGuard {
+private:
+    BasicPageGuard guard_;
+
+public:
+    WritePageGuard() = default;
+
+    /** @brief Adopts a pinned page whose exclusive latch is already held. */
+    WritePageGuard(BufferPoolManager* bpm, Page* page) : guard_(bpm, page) { guard_.is_dirty_ = true; }
+
+    WritePageGuard(WritePageGuard&&) noexcept = default;
+
+    WritePageGuard& operator=(WritePageGuard&& other) noexcept {
+        if (this != &other) {
+            Drop();
+            guard_ = std::move(other.guard_);
+        }
+        return *this;
+    }
+
+    ~WritePageGuard() { Drop(); }
+
+    /**
+     * @brief Releases the latch, then the pin.
+     */
+    void Drop() {
+        if (guard_.page_ != nullptr) guard_.page_->WUnlatch();
+        guard_.Drop();
+    }
+
+    explicit operator bool() const { return static_cast<bool>(guard_); }
+
+    page_id_t PageId() const { return guard_.PageId(); }
+
+    const char* GetData() const { return guard_.GetData(); }
+
+    char* GetDataMut() { return guard_.GetDataMut(); }
+
+    template <typename T>
+    const T* As() const { return guard_.As<T>(); }
+
+    template <typename T>
+    T* AsMut() { return guard_.AsMut<T>(); }
+};
+
+/* ------------------------------------------------------------------------ */
+/*                             Buffer pool manager                          */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Tuning knobs of the buffer pool.
+ */
+struct BufferPoolOptions {
+    size_t pool_size = 1024;                            ///< Number of frames.
+    size_t replacer_k = 2;                              ///< K of the LRU-K replacer.
+    std::chrono::milliseconds flush_interval{0};        ///< Background flush period; 0 disables it.
+    size_t flush_batch_pages = 256;                     ///< Dirty pages written per background round.
+};
+
+/**
+ * @brief Caches pages of a DiskManager in a fixed array of frames.
+ *
+ * A page table maps resident page ids to frames. Frames come from a free
+ * list first and otherwise from an LRUKReplacer; pinned frames are never
+ * evicted, and a dirty victim is written back before its frame is reused.
+ *
+ * Disk I/O runs without the pool latch. A frame being read in or written
+ * back is marked io_pending and stays in the page table, so a concurrent
+ * lookup of its page waits on a condition variable instead of reading the
+ * page twice or reading stale data. If a read fails, the frame returns to
+ * the free list; if a write-back fails, the victim stays resident and
+ * dirty. Either way the exception propagates to the caller.
+ *
+ * Pages are pinned by FetchPage()/NewPage() and released with UnpinPage(),
+ * or, preferably, through the RAII guards returned by the *Guarded/Read/
+ * Write variants.
+ *
+ * With a nonzero flush interval a background thread periodically writes
+ * dirty pages: it pins a batch of them, sorts the batch by page id and
+ * writes each run of consecutive ids with one vectored write, reading every
+ * page under its shared latch. The dirty flag is cleared before the write,
+ * so a writer that modifies the page meanwhile marks it dirty again when it
+ * unpins. A failed batch leaves its unwritten pages dirty; the flusher
+ * retries them in the next round.
+ */
+class BufferPoolManager {
+private:
+    size_t pool_size_;
+    DiskManager& disk_;
+    std::vector<Page> pages_;
+    std::unordered_map<page_id_t, frame_id_t> page_table_;
+    std::list<frame_id_t> free_list_;
+    LRUKReplacer replacer_;
+    std::mutex latch_;  ///< Guards page table, free list and page metadata.
+    std::condition_variable io_cv_;  ///< Signalled when a frame's io_pending_ clears.
+
+    std::chrono::milliseconds flush_interval_;
+    size_t flush_batch_pages_;
+    std::thread flusher_;
+    std::condition_variable flusher_cv_;
+    bool stop_flusher_ = false;
+
+    frame_id_t FrameOf(const Page* page) const { return static_cast<frame_id_t>(page - pages_.data()); }
+
+    /**
+     * @brief Returns the resident, settled frame holding `page_id`, or -1.
+     *
+     * Waits while the frame is being read or written back. Called with
+     * `lock` held on latch_; it may be released while waiting.
+     */
+    frame_id_t FindFrame(std::unique_lock<std::mutex>& lock, page_id_t page_id) {
+        for (;;) {
+            auto it = page_table_.find(page_id);
+            if (it == page_table_.end()) return -1;
+            if (!pages_[it->second].io_pending_) return it->second;
+            io_cv_.wait(lock);
+        }
+    }
+
+    /** @brief Pins a resident frame. Called under latch_. */
+    void Pin(frame_id_t frame) {
+        if (pages_[frame].pin_count_++ == 0) replacer_.SetEvictable(frame, false);
+    }
+
+    /** @brief Drops a pin taken by Pin() or Install(). Called under latch_. */
+    void Unpin(frame_id_t frame) {
+        if (--pages_[frame].pin_count_ == 0) replacer_.SetEvictable(frame, true);
+    }
+
+    /** @brief Clears io_pending_ on a frame and wakes the waiters. Called under latch_. */
+    void FinishIO(Page& page) {
+        page.io_pending_ = false;
+        io_cv_.notify_all();
+    }
+
+    /**
+     * @brief Finds a frame for a new resident page, writing back a dirty victim.
+     *
+     * Called with `lock` held on latch_. The lock is released around the
+     * write-back; the victim stays in the page table, marked io_pending,
+     * until its frame is handed out.
+     *
+     * @return The frame, or -1 if every frame is pinned.
+     */
+    frame_id_t AcquireFrame(std::unique_lock<std::mutex>& lock) {
+        if (!free_list_.empty()) {
+            frame_id_t frame = free_list_.front();
+            free_list_.pop_front();
+            return frame;
+        }
+        std::optional<frame_id_t> victim = replacer_.Evict();
+        if (!victim.has_value()) return -1;
+        Page& page = pages_[*victim];
+        if (page.is_dirty_) {
+            // Unpinned, so nobody holds the rwlatch and the contents are stable.
+            page.io_pending_ = true;
+            lock.unlock();
+            try {
+                disk_.WritePage(page.page_id_, page.data_);
+            } catch (...) {
+                lock.lock();
+                replacer_.RecordAccess(*victim);
+                replacer_.SetEvictable(*victim, true);
+                FinishIO(page);
+                throw;
+            }
+            lock.lock();
+            FinishIO(page);
+        }
+        page_table_.erase(page.page_id_);
+        page.Reset();
+        return *victim;
+    }
+
+    /** @brief Installs a page in a frame, pinned once. Called under latch_. */
+    Page* Install(frame_id_t frame, page_id_t page_id, AccessType type) {
+        Page& page = pages_[frame];
+        page.page_id_ = page_id;
+        page.pin_count_ = 1;
+        page_table_[page_id] = frame;
+        replacer_.RecordAccess(frame, type);
+        replacer_.SetEvictable(frame, false);
+        return &page;
+    }
+
+    /**
+     * @brief Writes one batch of dirty pages; returns how many were written.
+     */
+    size_t FlushDirtyBatch(size_t max_pages) {
+        std::vector<Page*> batch;
+        {
+            std::lock_guard<std::mutex> guard(latch_);
+            for (Page& page : pages_) {
+                if (batch.size() == max_pages) break;
+                if (page.page_id_ == kInvalidPageId || !page.is_dirty_ || page.io_pending_) continue;
+                Pin(FrameOf(&page));
+                page.is_dirty_ = false;
+                batch.push_back(&page);
+            }
+        }
+        if (batch.empty()) return 0;
+
+        std::sort(batch.begin(), batch.end(),
+                  [](const Page* a, const Page* b) { return a->page_id_ < b->page_id_; });
+        size_t begin = 0;
+        while (begin < batch.size()) {
+            // Block on the first latch of a run only; later pages join the run
+            // if their latch is free, so a writer holding several pages can
+            // never deadlock with the flusher.
+            batch[begin]->RLatch();
+            size_t end = begin + 1;
+            while (end < batch.size() && batch[end]->page_id_ == batch[end - 1]->page_id_ + 1 &&
+                   batch[end]->TryRLatch()) {
+                ++end;
+            }
+            std::vector<std::pair<page_id_t, const char*>> run;
+            for (size_t i = begin; i < end; ++i) run.emplace_back(batch[i]->page_id_, batch[i]->data_);
+            try {
+                disk_.WritePages(run);
+            } catch (...) {
+                for (size_t i = begin; i < end; ++i) batch[i]->RUnlatch();
+                std::lock_guard<std::mutex> guard(latch_);
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    if (i >= begin) batch[i]->is_dirty_ = true;
+                    Unpin(FrameOf(batch[i]));
+                }
+                throw;
+            }
+            for (size_t i = begin; i < end; ++i) batch[i]->RUnlatch();
+            begin = end;
+        }
+
+        std::lock_guard<std::mutex> guard(latch_);
+        for (Page* page : batch) Unpin(FrameOf(page));
+        return batch.size();
+    }
+
+    void FlusherLoop() {
+        std::unique_lock<std::mutex> lock(latch_);
+        while (!stop_flusher_) {
+            flusher_cv_.wait_for(lock, flush_interval_, [this] { return stop_flusher_; });
+            if (stop_flusher_) break;
+            lock.unlock();
+            try {
+                FlushDirtyBatch(flush_batch_pages_);
+            } catch (const std::exception&) {
+                // The pages stay dirty; the next round or FlushAllPages() retries.
+            }
+            lock.lock();
+        }
+    }
+
+public:
+    /**
+     * @brief Creates the pool; starts the background flusher if configured.
+     *
+     * @param disk Page file; must outlive the pool.
+     * @param options Pool size, replacer K and flusher settings.
+     */
+    BufferPoolManager(DiskManager& disk, BufferPoolOptions options = {})
+        : pool_size_(options.pool_size),
+          disk_(disk),
+          pages_(options.pool_size),
+          replacer_(options.pool_size, options.replacer_k),
+          flush_interval_(options.flush_interval),
+          flush_batch_pages_(std::max<size_t>(1, options.flush_batch_pages)) {
+        if (pool_size_ == 0) throw std::invalid_argument("BufferPoolManager needs at least one frame");
+        for (size_t i = 0; i < pool_size_; ++i) free_list_.push_back(static_cast<frame_id_t>(i));
+        if (flush_interval_.count() > 0) flusher_ = std::thread([this] { FlusherLoop(); });
+    }
+
+    BufferPoolManager(const BufferPoolManager&) = delete;
+    BufferPoolManager& operator=(const BufferPoolManager&) = delete;
+
+    /**
+     * @brief Stops the flusher and writes back every dirty page.
+     *
+     * Write errors are swallowed here; call FlushAllPages() first to see them.
+     */
+    ~BufferPoolManager() {
+        {
+            std::lock_guard<std::mutex> guard(latch_);
+            stop_flusher_ = true;
+        }
+        flusher_cv_.notify_all();
+        if (flusher_.joinable()) flusher_.join();
+        try {
+            FlushAllPages();
+        } catch (const std::exception&) {
+        }
+    }
+
+    size_t GetPoolSize() const { return pool_size_; }
+
+    /**
+     * @brief Allocates a new zeroed page and pins it.
+     *
+     * @param[out] page_id Id of the new page.
+     * @return The page, or nullptr if every frame is pinned.
+     */
+    Page* NewPage(page_id_t* page_id) {
+        std::unique_lock<std::mutex> lock(latch_);
+        frame_id_t frame = AcquireFrame(lock);
+        if (frame < 0) return nullptr;
+        *page_id = disk_.AllocatePage();
+        return Install(frame, *page_id, AccessType::kUnknown);
+    }
+
+    /**
+     * @brief Pins a page, reading it from disk if it is not resident.
+     *
+     * @param type Access type hint for the replacer; sequential scans should
+     *        pass AccessType::kScan so they do not displace the working set.
+     * @return The page, or nullptr if every frame is pinned.
+     * @throws std::out_of_range if the page was never allocated;
+     *         std::system_error if reading it or writing back a victim fails.
+     */
+    Page* FetchPage(page_id_t page_id, AccessType type = AccessType::kUnknown) {
+        disk_.CheckPageId(page_id);
+        std::unique_lock<std::mutex> lock(latch_);
+        for (;;) {
+            frame_id_t resident = FindFrame(lock, page_id);
+            if (resident >= 0) {
+                replacer_.RecordAccess(resident, type);
+                Pin(resident);
+                return &pages_[resident];
+            }
+            frame_id_t frame = AcquireFrame(lock);
+            if (frame < 0) return nullptr;
+            if (page_table_.count(page_id) != 0) {
+                // Another thread loaded the page while a victim was written back.
+                free_list_.push_front(frame);
+                continue;
+            }
+
+            Page& page = pages_[frame];
+            page.page_id_ = page_id;
+            page.io_pending_ = true;
+            page_table_[page_id] = frame;
+            lock.unlock();
+            try {
+                disk_.ReadPage(page_id, page.data_);
+            } catch (...) {
+                lock.lock();
+                page_table_.erase(page_id);
+                page.Reset();
+                free_list_.push_back(frame);
+                io_cv_.notify_all();
+                throw;
+            }
+            lock.lock();
+            FinishIO(page);
+            return Install(frame, page_id, type);
+        }
+    }
+
+    /**
+     * @brief Drops one pin; the frame becomes evictable when none remain.
+     *
+     * @param is_dirty Whether the caller modified the page.
+     * @return False if the page is not resident or not pinned.
+     */
+    bool UnpinPage(page_id_t page_id, bool is_dirty) {
+        std::lock_guard<std::mutex> guard(latch_);
+        auto it = page_table_.find(page_id);
+        if (it == page_table_.end()) return false;
+        Page& page = pages_[it->second];
+        if (page.pin_count_ <= 0) return false;
+        page.is_dirty_ |= is_dirty;
+        Unpin(it->second);
+        return true;
+    }
+
+    /**
+     * @brief Writes a resident page to disk regardless of its dirty flag.
+     *
+     * The page is pinned and read under its shared latch, without the pool
+     * latch; the caller must not hold the page's exclusive latch.
+     *
+     * @return False if the page is not resident.
+     */
+    bool FlushPage(page_id_t page_id) {
+        std::unique_lock<std::mutex> lock(latch_);
+        frame_id_t frame = FindFrame(lock, page_id);
+        if (frame < 0) return false;
+        Page& page = pages_[frame];
+        Pin(frame);
+        page.is_dirty_ = false;
+        lock.unlock();
+
+        page.RLatch();
+        try {
+            disk_.WritePage(page_id, page.data_);
+        } catch (...) {
+            page.RUnlatch();
+            lock.lock();
+            page.is_dirty_ = true;
+            Unpin(frame);
+            throw;
+        }
+        page.RUnlatch();
+        lock.lock();
+        Unpin(frame);
+        return true;
+    }
+
+    /**
+     * @brief Writes every dirty page in sorted, batched order.
+     */
+    void FlushAllPages() {
+        while (FlushDirtyBatch(flush_batch_pages_) > 0) {}
+    }
+
+    /**
+     * @brief Drops an unpinned page from the pool. The page id is not reused.
+     *
+     * @return False if the page is pinned or in I/O; true if it was removed or not resident.
+     */
+    bool DeletePage(page_id_t page_id) {
+        std::lock_guard<std::mutex> guard(latch_);
+        auto it = page_table_.find(page_id);
+        if (it == page_table_.end()) return true;
+        frame_id_t frame = it->second;
+        Page& page = pages_[frame];
+        if (page.pin_count_ > 0 || page.io_pending_) return false;
+        replacer_.Remove(frame);
+        page_table_.erase(it);
+        page.Reset();
+        free_list_.push_back(frame);
+        return true;
+    }
+
+    BasicPageGuard NewPageGuarded(page_id_t* page_id) { return {this, NewPage(page_id)}; }
+
+    BasicPageGuard FetchPageBasic(page_id_t page_id, AccessType type = AccessType::kUnknown) {
+        return {this, FetchPage(page_id, type)};
+    }
+
+    ReadPageGuard FetchPageRead(page_id_t page_id, AccessType type = AccessType::kUnknown) {
+        Page* page = FetchPage(page_id, type);
+        if (page == nullptr) return {};
+        page->RLatch();
+        return {this, page};
+    }
+
+    WritePageGuard FetchPageWrite(page_id_t page_id, AccessType type = AccessType::kUnknown) {
+        Page* page = FetchPage(page_id, type);
+        if (page == nullptr) return {};
+        page->WLatch();
+        return {this, page};
+    }
+};
+
+inline void BasicPageGuard::Drop() {
+    if (page_ != nullptr) bpm_->UnpinPage(page_->GetPageId(), is_dirty_);
+    bpm_ = nullptr;
+    page_ = nullptr;
+    is_dirty_ = false;
+}
+
+} // namespace Collections
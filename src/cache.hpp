@@ -0,0 +1,610 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "flat_hash_map.hpp"
+#include "lru_k_tracker.hpp"
+#include "transparent_hash.hpp"
+
+/**
+ * @file cache.hpp
+ * @brief Policy-based cache front-end.
+ *
+ * Cache<K, V, Policy, Index, Stats, Lock> owns the entries, the key index,
+ * instrumentation and locking; the replacement decision is delegated to a
+ * Policy. Switching a call site from LRU to CLOCK or LRU-K is a change of one
+ * template argument:
+ *
+ * @code
+ * Cache<std::string, Blob, LRUPolicy> cache(1024);
+ * Cache<std::string, Blob, LRUKPolicy<2>, UnorderedIndex, CounterStats, std::mutex> cache(1024);
+ * @endcode
+ *
+ * A Policy is a tag type with two nested templates:
+ *  - `Hook<Entry>`: per-entry metadata embedded in every entry;
+ *  - `Impl<Entry>`: the policy state, constructed from (capacity, const Policy&)
+ *    and providing OnInsert, OnAccess, OnErase (all taking Entry*) and
+ *    Victim(), which returns the entry to evict or nullptr.
+ * Optionally, OnInsert and OnAccess also take an AccessType hint, and
+ * OnEvict(Entry*) replaces OnErase for evicted entries.
+ * Policy objects carry the policy's configuration (for example the protected
+ * ratio of an SLRU) and are passed to the Cache constructor.
+ */
+
+namespace Collections {
+
+/* ------------------------------------------------------------------------ */
+/*                                  Entries                                 */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief A cached key-value pair plus the policy's per-entry metadata.
+ */
+template <typename K, typename V, typename Policy>
+struct CacheEntry {
+    using key_type = K;
+
+    K key;
+    V value;
+    typename Policy::template Hook<CacheEntry> hook;
+
+    CacheEntry(K k, V v) : key(std::move(k)), value(std::move(v)) {}
+};
+
+/**
+ * @brief Requirements on a replacement policy's implementation for an entry type.
+ */
+template <typename Policy, typename Entry>
+concept ReplacementPolicyFor =
+    std::constructible_from<typename Policy::template Impl<Entry>, size_t, const Policy&> &&
+    requires(typename Policy::template Impl<Entry>& impl, Entry* entry) {
+        impl.OnInsert(entry);
+        impl.OnAccess(entry);
+        impl.OnErase(entry);
+        { impl.Victim() } -> std::same_as<Entry*>;
+    };
+
+/* ------------------------------------------------------------------------ */
+/*                                 Policies                                 */
+/* ------------------------------------------------------------------------ */
+
+namespace detail {
+
+/**
+ * @brief Doubly linked list threaded through a `prev`/`next` pair of an
+ *        entry's hook, selected by the Links functor.
+ */
+template <typename Entry, typename Links>
+class IntrusiveList {
+private:
+    Entry* head_ = nullptr;  ///< Front (most recent for LRU lists).
+    Entry* tail_ = nullptr;  ///< Back.
+    size_t size_ = 0;
+
+public:
+    void PushFront(Entry* entry) {
+        auto& links = Links{}(entry);
+        links.prev = nullptr;
+        links.next = head_;
+        if (head_ != nullptr) Links{}(head_).prev = entry;
+        else tail_ = entry;
+        head_ = entry;
+        ++size_;
+    }
+
+    void PushBack(Entry* entry) {
+        auto& links = Links{}(entry);
+        links.next = nullptr;
+        links.prev = tail_;
+        if (tail_ != nullptr) Links{}(tail_).next = entry;
+        else head_ = entry;
+        tail_ = entry;
+        ++size_;
+    }
+
+    void Unlink(Entry* entry) {
+        auto& links = Links{}(entry);
+        if (links.prev != nullptr) Links{}(links.prev).next = links.next;
+        else head_ = links.next;
+        if (links.next != nullptr) Links{}(links.next).prev = links.prev;
+        else tail_ = links.prev;
+        links.prev = links.next = nullptr;
+        --size_;
+    }
+
+    Entry* front() const { return head_; }
+    Entry* back() const { return tail_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+};
+
+/** @brief Selects `entry->hook` as the list links. */
+struct HookLinks {
+    template <typename Entry>
+    auto& operator()(Entry* entry) const { return entry->hook; }
+};
+
+} // namespace detail
+
+/**
+ * @brief Least recently used replacement.
+ */
+struct LRUPolicy {
+    template <typename Entry>
+    struct Hook {
+        Entry* prev = nullptr;
+        Entry* next = nullptr;
+    };
+
+    template <typename Entry>
+    class Impl {
+    private:
+        detail::IntrusiveList<Entry, detail::HookLinks> list_;  ///< Front is most recent.
+
+    public:
+        Impl(size_t, const LRUPolicy&) {}
+
+        void OnInsert(Entry* entry) { list_.PushFront(entry); }
+
+        void OnAccess(Entry* entry) {
+            list_.Unlink(entry);
+            list_.PushFront(entry);
+        }
+
+        void OnErase(Entry* entry) { list_.Unlink(entry); }
+
+        Entry* Victim() { return list_.back(); }
+    };
+};
+
+/**
+ * @brief CLOCK (second chance) replacement.
+ *
+ * Entries sit on a ring swept by a hand. An access only sets a reference
+ * bit, so hits never reorder anything; the hand clears bits until it finds
+ * an unreferenced entry to evict.
+ */
+struct ClockPolicy {
+    template <typename Entry>
+    struct Hook {
+        Entry* prev = nullptr;
+        Entry* next = nullptr;
+        bool referenced = false;
+    };
+
+    template <typename Entry>
+    class Impl {
+    private:
+        Entry* hand_ = nullptr;
+
+    public:
+        Impl(size_t, const ClockPolicy&) {}
+
+        /** @brief New entries are placed just behind the hand, the last spot it reaches. */
+        void OnInsert(Entry* entry) {
+            entry->hook.referenced = false;
+            if (hand_ == nullptr) {
+                entry->hook.prev = entry->hook.next = entry;
+                hand_ = entry;
+                return;
+            }
+            Entry* behind = hand_->hook.prev;
+            entry->hook.prev = behind;
+            entry->hook.next = hand_;
+            behind->hook.next = entry;
+            hand_->hook.prev = entry;
+        }
+
+        void OnAccess(Entry* entry) { entry->hook.referenced = true; }
+
+        void OnErase(Entry* entry) {
+            if (entry->hook.next == entry) {
+                hand_ = nullptr;
+            } else {
+                if (hand_ == entry) hand_ = entry->hook.next;
+                entry->hook.prev->hook.next = entry->hook.next;
+                entry->hook.next->hook.prev = entry->hook.prev;
+            }
+            entry->hook.prev = entry->hook.next = nullptr;
+        }
+
+        Entry* Victim() {
+            if (hand_ == nullptr) return nullptr;
+            while (hand_->hook.referenced) {
+                hand_->hook.referenced = false;
+                hand_ = hand_->hook.next;
+            }
+            return hand_;
+        }
+    };
+};
+
+/**
+ * @brief Segmented LRU replacement.
+ *
+ * New entries enter a probationary segment. A hit on a probationary entry
+ * promotes it to the protected segment; when the protected segment exceeds
+ * its share of the capacity its least recent entry is demoted back to the
+ * front of the probationary segment. Victims come from the back of the
+ * probationary segment, so a burst of one-hit wonders only churns that
+ * segment. Every operation is O(1).
+ */
+struct SLRUPolicy {
+    double protected_ratio = 0.8;  ///< Share of the capacity reserved for the protected segment.
+
+    template <typename Entry>
+    struct Hook {
+        Entry* prev = nullptr;
+        Entry* next = nullptr;
+        bool is_protected = false;
+    };
+
+    template <typename Entry>
+    class Impl {
+    private:
+        detail::IntrusiveList<Entry, detail::HookLinks> probation_;  ///< Front is most recent.
+        detail::IntrusiveList<Entry, detail::HookLinks> protected_;  ///< Front is most recent.
+        size_t protected_capacity_;
+
+    public:
+        Impl(size_t capacity, const SLRUPolicy& policy)
+            : protected_capacity_(static_cast<size_t>(capacity * policy.protected_ratio)) {
+            if (!(policy.protected_ratio >= 0.0 && policy.protected_ratio <= 1.0))
+                throw std::invalid_argument("SLRU protected ratio must be in [0, 1]");
+        }
+
+        void OnInsert(Entry* entry) {
+            entry->hook.is_protected = false;
+            probation_.PushFront(entry);
+        }
+
+        void OnAccess(Entry* entry) {
+            if (entry->hook.is_protected) {
+                protected_.Unlink(entry);
+                protected_.PushFront(entry);
+                return;
+            }
+            probation_.Unlink(entry);
+            if (protected_capacity_ == 0) {
+                probation_.PushFront(entry);
+                return;
+            }
+            entry->hook.is_protected = true;
+            protected_.PushFront(entry);
+            if (protected_.size() > protected_capacity_) {
+                Entry* demoted = protected_.back();
+                protected_.Unlink(demoted);
+                demoted->hook.is_protected = false;
+                probation_.PushFront(demoted);
+            }
+        }
+
+        void OnErase(Entry* entry) {
+            if (entry->hook.is_protected) protected_.Unlink(entry);
+            else probation_.Unlink(entry);
+        }
+
+        Entry* Victim() { return !probation_.empty() ? probation_.back() : protected_.back(); }
+    };
+};
+
+/**
+ * @brief LRU-K replacement with a compile-time K.
+ *
+ * Runs the detail::LRUKTracker that LRU_K_Cache<K, V, K> uses, so
+ * Cache<..., LRUKPolicy<K>> evicts the same entries as LRU_K_Cache given the
+ * same operations, access-type hints and configuration: sub-K entries
+ * first, oldest first access first, then the oldest K-th most recent access.
+ * Keys need std::hash for the retained-history table.
+ *
+ * @tparam K Number of accesses tracked per entry.
+ */
+template <size_t K = 2>
+struct LRUKPolicy {
+    static_assert(K >= 1, "LRU-K needs K >= 1");
+
+    size_t retained_history = 0;    ///< Ghosts kept for evicted keys; 0 disables (see LRU_K_Cache::set_retained_history).
+    uint64_t retained_period = 0;   ///< Ghosts idle longer than this are not resumed; 0 means no limit.
+    uint64_t correlated_period = 0; ///< Correlated Reference Period in ticks; 0 disables.
+
+    template <typename Entry>
+    using Hook = detail::LRUKHook<K>;
+
+    template <typename Entry>
+    class Impl {
+    private:
+        struct EntryTraits {
+            detail::LRUKHook<K>& hook(Entry* entry) const { return entry->hook; }
+            const typename Entry::key_type& key(Entry* entry) const { return entry->key; }
+        };
+
+        detail::LRUKTracker<Entry*, typename Entry::key_type, K, EntryTraits> tracker_;
+
+    public:
+        Impl(size_t, const LRUKPolicy& policy) : tracker_(K) {
+            tracker_.set_retained_history(policy.retained_history, policy.retained_period);
+            tracker_.set_correlated_reference_period(policy.correlated_period);
+        }
+
+        void OnInsert(Entry* entry, AccessType type = AccessType::kUnknown) {
+            tracker_.Admit(entry, type);
+            tracker_.Enqueue(entry);
+        }
+
+        void OnAccess(Entry* entry, AccessType type = AccessType::kUnknown) { tracker_.Access(entry, type); }
+
+        void OnErase(Entry* entry) { tracker_.Dequeue(entry); }
+
+        void OnEvict(Entry* entry) {
+            tracker_.Dequeue(entry);
+            tracker_.Retain(entry, entry->key);
+        }
+
+        Entry* Victim() { return tracker_.empty() ? nullptr : tracker_.Victim(); }
+    };
+};
+
+/* ------------------------------------------------------------------------ */
+/*                          Index, stats and locks                          */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Key index backed by std::unordered_map.
+ */
+struct UnorderedIndex {
+    template <typename Key, typename Mapped, typename Hash, typename KeyEqual>
+    using map_type = std::unordered_map<Key, Mapped, Hash, KeyEqual>;
+};
+
+/**
+ * @brief Key index backed by FlatHashMap; no allocation per entry.
+ */
+struct FlatIndex {
+    template <typename Key, typename Mapped, typename Hash, typename KeyEqual>
+    using map_type = FlatHashMap<Key, Mapped, Hash, KeyEqual>;
+};
+
+/**
+ * @brief Instrumentation that records nothing.
+ */
+struct NoStats {
+    void RecordHit() {}
+    void RecordMiss() {}
+    void RecordInsert() {}
+    void RecordEviction() {}
+};
+
+/**
+ * @brief Instrumentation with plain counters (updated under the cache lock).
+ */
+struct CounterStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;
+
+    void RecordHit() { ++hits; }
+    void RecordMiss() { ++misses; }
+    void RecordInsert() { ++inserts; }
+    void RecordEviction() { ++evictions; }
+
+    double HitRatio() const {
+        uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+    }
+};
+
+/**
+ * @brief Lock that does nothing, for single-threaded caches.
+ */
+struct NullLock {
+    void lock() {}
+    void unlock() {}
+};
+
+/* ------------------------------------------------------------------------ */
+/*                                 Front-end                                */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief A bounded key-value cache with pluggable replacement, index,
+ *        instrumentation and locking.
+ *
+ * @tparam K Key type.
+ * @tparam V Value type.
+ * @tparam Policy Replacement policy (LRUPolicy, ClockPolicy, SLRUPolicy, LRUKPolicy<K>, ...).
+ * @tparam Index Key index (UnorderedIndex, FlatIndex, ...).
+ * @tparam Stats Instrumentation (NoStats, CounterStats, ...).
+ * @tparam Lock BasicLockable guarding every operation (NullLock, std::mutex, ...).
+ * @tparam Hash Hash functor, may be transparent.
+ * @tparam KeyEqual Equality functor, may be transparent.
+ */
+template <typename K, typename V, typename Policy = LRUPolicy, typename Index = UnorderedIndex,
+          typename Stats = NoStats, typename Lock = NullLock, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+    requires ReplacementPolicyFor<Policy, CacheEntry<K, V, Policy>>
+class Cache {
+private:
+    using Entry = CacheEntry<K, V, Policy>;
+    using Map = typename Index::template map_type<K, Entry*, Hash, KeyEqual>;
+
+    size_t capacity_;
+    Map index_;
+    typename Policy::template Impl<Entry> policy_;
+    Stats stats_;
+    mutable Lock lock_;
+    std::function<void(K&&, V&&)> eviction_listener_;
+
+    /** @brief Passes the hint on to policies that take one. */
+    void Access(Entry* entry, AccessType type) {
+        if constexpr (requires { policy_.OnAccess(entry, type); }) {
+            policy_.OnAccess(entry, type);
+        } else {
+            policy_.OnAccess(entry);
+        }
+    }
+
+    template <typename Q>
+    std::optional<V> Lookup(const Q& key, AccessType type) {
+        std::lock_guard<Lock> guard(lock_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            stats_.RecordMiss();
+            return std::nullopt;
+        }
+        Access(it->second, type);
+        stats_.RecordHit();
+        return it->second->value;
+    }
+
+    template <typename Q>
+    bool Erase(const Q& key) {
+        std::lock_guard<Lock> guard(lock_);
+        auto it = index_.find(key);
+        if (it == index_.end()) return false;
+        Entry* entry = it->second;
+        index_.erase(it);
+        policy_.OnErase(entry);
+        delete entry;
+        return true;
+    }
+
+    std::unique_ptr<Entry> EvictOne() {
+        std::unique_ptr<Entry> victim(policy_.Victim());
+        if (victim == nullptr) return nullptr;
+        if constexpr (requires { policy_.OnEvict(victim.get()); }) {
+            policy_.OnEvict(victim.get());
+        } else {
+            policy_.OnErase(victim.get());
+        }
+        index_.erase(victim->key);
+        stats_.RecordEviction();
+        return victim;
+    }
+
+public:
+    /**
+     * @brief Creates an empty cache.
+     *
+     * @param capacity Maximum number of entries.
+     * @param policy Policy configuration.
+     */
+    explicit Cache(size_t capacity, const Policy& policy = Policy())
+        : capacity_(capacity), policy_(capacity, policy) {
+        if (capacity_ == 0) throw std::invalid_argument("Cache capacity must be positive");
+    }
+
+    Cache(const Cache&) = delete;
+    Cache& operator=(const Cache&) = delete;
+
+    ~Cache() {
+        for (auto& [_, entry] : index_) delete entry;
+    }
+
+    /**
+     * @brief Returns a copy of the value and records the access.
+     *
+     * @param type Access type hint; policies without hints ignore it.
+     */
+    std::optional<V> get(const K& key, AccessType type = AccessType::kUnknown) { return Lookup(key, type); }
+
+    template <typename Q>
+        requires TransparentLookup<Hash, KeyEqual>
+    std::optional<V> get(const Q& key, AccessType type = AccessType::kUnknown) {
+        return Lookup(key, type);
+    }
+
+    /**
+     * @brief Inserts or replaces a value; a replacement counts as an access.
+     *
+     * @param type Access type hint; policies without hints ignore it.
+     */
+    void put(K key, V value, AccessType type = AccessType::kUnknown) {
+        std::lock_guard<Lock> guard(lock_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            it->second->value = std::move(value);
+            Access(it->second, type);
+            return;
+        }
+        std::unique_ptr<Entry> victim;
+        if (index_.size() >= capacity_) victim = EvictOne();
+
+        auto entry = std::make_unique<Entry>(key, std::move(value));
+        index_.emplace(std::move(key), entry.get());
+        if constexpr (requires { policy_.OnInsert(entry.get(), type); }) {
+            policy_.OnInsert(entry.release(), type);
+        } else {
+            policy_.OnInsert(entry.release());
+        }
+        stats_.RecordInsert();
+
+        if (victim != nullptr && eviction_listener_)
+            eviction_listener_(std::move(victim->key), std::move(victim->value));
+    }
+
+    /**
+     * @brief Removes a key.
+     * @return True if the key was present.
+     */
+    bool erase(const K& key) { return Erase(key); }
+
+    template <typename Q>
+        requires TransparentLookup<Hash, KeyEqual>
+    bool erase(const Q& key) {
+        return Erase(key);
+    }
+
+    /**
+     * @brief Membership test; does not count as an access.
+     */
+    bool contains(const K& key) const {
+        std::lock_guard<Lock> guard(lock_);
+        return index_.find(key) != index_.end();
+    }
+
+    template <typename Q>
+        requires TransparentLookup<Hash, KeyEqual>
+    bool contains(const Q& key) const {
+        std::lock_guard<Lock> guard(lock_);
+        return index_.find(key) != index_.end();
+    }
+
+    size_t size() const {
+        std::lock_guard<Lock> guard(lock_);
+        return index_.size();
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Sets a function called with every entry evicted by put().
+     *
+     * It runs under the cache lock once the new entry is in place. If it
+     * throws, the evicted entry is dropped and the exception propagates out
+     * of put().
+     */
+    void set_eviction_listener(std::function<void(K&&, V&&)> listener) {
+        std::lock_guard<Lock> guard(lock_);
+        eviction_listener_ = std::move(listener);
+    }
+
+    /**
+     * @brief Returns a snapshot of the instrumentation.
+     */
+    Stats stats() const {
+        std::lock_guard<Lock> guard(lock_);
+        return stats_;
+    }
+};
+
+} // namespace Collections
@@ -0,0 +1,487 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cache.hpp"
+#include "fixed_lru.hpp"
+#include "lru_cache.hpp"
+#include "lrfu_cache.hpp"
+#include "lru_k_replacer.hpp"
+
+/**
+ * @file cache_simulator.hpp
+ * @brief Trace-driven simulator used to compare cache replacement policies.
+ *
+ * A trace is a sequence of 64-bit keys. Every access is a lookup; on a miss the
+ * key is inserted, the same way a read-through cache would behave in front of a
+ * backend. Policies are plugged in through the CachePolicy interface so new
+ * replacement strategies only need a small adapter to be benchmarked.
+ */
+
+namespace Collections::Simulation {
+
+/** @brief Key type used by traces. */
+using trace_key_t = uint64_t;
+
+/** @brief A sequence of key accesses. */
+using Trace = std::vector<trace_key_t>;
+
+/* ------------------------------------------------------------------------ */
+/*                               Trace files                                */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Loads a text trace: one unsigned decimal key per line.
+ *
+ * Blank lines and lines starting with '#' are ignored.
+ *
+ * @param path Path of the trace file.
+ * @return The keys in file order.
+ * @throws std::runtime_error if the file cannot be opened or a line is malformed.
+ */
+inline Trace LoadTextTrace(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot open trace file: " + path);
+
+    Trace trace;
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        try {
+            trace.push_back(std::stoull(line.substr(first)));
+        } catch (const std::exception&) {
+            throw std::runtime_error("Malformed key at " + path + ":" + std::to_string(line_no));
+        }
+    }
+    return trace;
+}
+
+/**
+ * @brief Loads a binary trace: a flat array of little-endian uint64 keys.
+ *
+ * @param path Path of the trace file.
+ * @return The keys in file order.
+ * @throws std::runtime_error if the file cannot be opened or is truncated.
+ */
+inline Trace LoadBinaryTrace(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("Cannot open trace file: " + path);
+
+    std::streamsize bytes = in.tellg();
+    if (bytes % sizeof(trace_key_t) != 0)
+        throw std::runtime_error("Truncated binary trace: " + path);
+
+    Trace trace(static_cast<size_t>(bytes) / sizeof(trace_key_t));
+    in.seekg(0);
+    unsigned char buffer[sizeof(trace_key_t)];
+    for (trace_key_t& key : trace) {
+        in.read(reinterpret_cast<char*>(buffer), sizeof(buffer));
+        key = 0;
+        for (size_t i = 0; i < sizeof(buffer); ++i)
+            key |= static_cast<trace_key_t>(buffer[i]) << (8 * i);
+    }
+    if (!in) throw std::runtime_error("Failed reading binary trace: " + path);
+    return trace;
+}
+
+/**
+ * @brief Writes a trace in the binary format read by LoadBinaryTrace().
+ *
+ * @param trace The keys to write.
+ * @param path Destination file (overwritten).
+ * @throws std::runtime_error if the file cannot be written.
+ */
+inline void SaveBinaryTrace(const Trace& trace, const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Cannot create trace file: " + path);
+
+    unsigned char buffer[sizeof(trace_key_t)];
+    for (trace_key_t key : trace) {
+        for (size_t i = 0; i < sizeof(buffer); ++i)
+            buffer[i] = static_cast<unsigned char>(key >> (8 * i));
+        out.write(reinterpret_cast<const char*>(buffer), sizeof(buffer));
+    }
+    if (!out) throw std::runtime_error("Failed writing trace file: " + path);
+}
+
+/* ------------------------------------------------------------------------ */
+/*                           Synthetic workloads                            */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Zipf-distributed accesses over keys [0, universe).
+ *
+ * Key rank r is drawn with probability proportional to 1 / (r + 1)^skew.
+ * Ranks are scattered over the key space so hot keys are not adjacent.
+ *
+ * @param length Number of accesses.
+ * @param universe Number of distinct keys.
+ * @param skew Zipf exponent (0.99 is a common web-cache value).
+ * @param seed Random seed.
+ */
+inline Trace ZipfTrace(size_t length, size_t universe, double skew, uint64_t seed = 42) {
+    if (universe == 0) throw std::invalid_argument("Zipf universe must not be empty");
+
+    std::vector<double> cdf(universe);
+    double sum = 0.0;
+    for (size_t rank = 0; rank < universe; ++rank) {
+        sum += 1.0 / std::pow(static_cast<double>(rank + 1), skew);
+        cdf[rank] = sum;
+    }
+
+    std::mt19937_64 rng(seed);
+    std::vector<trace_key_t> key_of_rank(universe);
+    for (size_t rank = 0; rank < universe; ++rank) key_of_rank[rank] = rank;
+    std::shuffle(key_of_rank.begin(), key_of_rank.end(), rng);
+
+    std::uniform_real_distribution<double> uniform(0.0, sum);
+    Trace trace(length);
+    for (trace_key_t& key : trace) {
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+        key = key_of_rank[std::min(rank, universe - 1)];
+    }
+    return trace;
+}
+
+/**
+ * @brief A single sequential pass over keys [first, first + length).
+ */
+inline Trace ScanTrace(size_t length, trace_key_t first = 0) {
+    Trace trace(length);
+    for (size_t i = 0; i < length; ++i) trace[i] = first + i;
+    return trace;
+}
+
+/**
+ * @brief Repeated sequential passes over keys [0, loop_size).
+ *
+ * Loops slightly larger than the cache are the classic worst case for LRU.
+ */
+inline Trace LoopTrace(size_t length, size_t loop_size) {
+    if (loop_size == 0) throw std::invalid_argument("Loop size must not be zero");
+    Trace trace(length);
+    for (size_t i = 0; i < length; ++i) trace[i] = i % loop_size;
+    return trace;
+}
+
+/**
+ * @brief Accesses concentrated on a hot window that moves over time.
+ *
+ * A fraction @p hot_fraction of the accesses go to a window of @p hot_size keys;
+ * the rest are uniform over the universe. Every @p phase_length accesses the
+ * window jumps to a new region, so policies must adapt to a changing working set.
+ */
+inline Trace ShiftingHotspotTrace(size_t length, size_t universe, size_t hot_size,
+                                  size_t phase_length, double hot_fraction = 0.9,
+                                  uint64_t seed = 42) {
+    if (universe == 0 || hot_size == 0 || phase_length == 0)
+        throw std::invalid_argument("Hotspot parameters must not be zero");
+    hot_size = std::min(hot_size, universe);
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::uniform_int_distribution<size_t> any_key(0, universe - 1);
+    std::uniform_int_distribution<size_t> hot_key(0, hot_size - 1);
+
+    Trace trace(length);
+    size_t hot_base = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (i != 0 && i % phase_length == 0) hot_base = any_key(rng);
+        trace[i] = coin(rng) < hot_fraction ? (hot_base + hot_key(rng)) % universe
+                                            : any_key(rng);
+    }
+    return trace;
+}
+
+/* ------------------------------------------------------------------------ */
+/*                                 Policies                                 */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Uniform interface the simulator drives.
+ */
+class CachePolicy {
+public:
+    virtual ~CachePolicy() = default;
+
+    /**
+     * @brief Looks the key up and inserts it on a miss.
+     * @return True on a hit.
+     */
+    virtual bool Access(trace_key_t key) = 0;
+
+    /** @brief Number of resident entries. */
+    virtual size_t Size() const = 0;
+};
+
+/** @brief Builds a fresh policy instance for a given capacity. */
+using PolicyFactory = std::function<std::unique_ptr<CachePolicy>(size_t capacity)>;
+
+/**
+ * @brief A named policy that can be replayed by the simulator.
+ */
+struct PolicySpec {
+    std::string name;
+    PolicyFactory make;
+};
+
+/**
+ * @brief Adapter for Collections::LRUCache.
+ */
+class LRUCachePolicy : public CachePolicy {
+private:
+    LRUCache<trace_key_t, trace_key_t> cache_;
+
+public:
+    explicit LRUCachePolicy(size_t capacity) : cache_(static_cast<int>(capacity)) {}
+
+    bool Access(trace_key_t key) override {
+        if (cache_.get(key).has_value()) return true;
+        cache_.put(key, key);
+        return false;
+    }
+
+    size_t Size() const override { return cache_.size(); }
+};
+
+/**
+ * @brief Adapter for Collections::LRU_K_Cache.
+ */
+class LRUKCachePolicy : public CachePolicy {
+private:
+    LRU_K_Cache<trace_key_t, trace_key_t> cache_;
+
+public:
+    LRUKCachePolicy(size_t capacity, size_t k, size_t ghosts = 0, timestamp_t correlated_period = 0)
+        : cache_(capacity, k) {
+        cache_.set_retained_history(ghosts);
+        cache_.set_correlated_reference_period(correlated_period);
+    }
+
+    bool Access(trace_key_t key) override {
+        if (cache_.Get(key).has_value()) return true;
+        trace_key_t k = key, v = key;
+        cache_.Put(std::move(k), std::move(v));
+        return false;
+    }
+
+    size_t Size() const override { return cache_.size(); }
+};
+
+/**
+ * @brief Adapter for Collections::LRFUCache.
+ *
+ * Traces carry no timestamps, so the cache's clock advances one millisecond
+ * per access and lambda is per second of that logical time.
+ */
+class LRFUCachePolicy : public CachePolicy {
+private:
+    std::chrono::steady_clock::time_point now_{};
+    LRFUCache<trace_key_t, trace_key_t> cache_;
+
+public:
+    LRFUCachePolicy(size_t capacity, double lambda) : cache_(capacity, lambda, [this] { return now_; }) {}
+
+    bool Access(trace_key_t key) override {
+        now_ += std::chrono::milliseconds(1);
+        if (cache_.get(key).has_value()) return true;
+        cache_.put(key, key);
+        return false;
+    }
+
+    size_t Size() const override { return cache_.size(); }
+};
+
+/**
+ * @brief Adapter for Collections::FixedLRU.
+ */
+class FixedLRUPolicy : public CachePolicy {
+private:
+    FixedLRU<trace_key_t, trace_key_t> cache_;
+
+public:
+    explicit FixedLRUPolicy(size_t capacity) : cache_(capacity) {}
+
+    bool Access(trace_key_t key) override {
+        if (cache_.find(key) != nullptr) return true;
+        cache_.put(key, key);
+        return false;
+    }
+
+    size_t Size() const override { return cache_.size(); }
+};
+
+/**
+ * @brief Adapter for the policy-based Collections::Cache front-end.
+ */
+template <typename Policy, typename Index = UnorderedIndex>
+class FrontEndPolicy : public CachePolicy {
+private:
+    Cache<trace_key_t, trace_key_t, Policy, Index> cache_;
+
+public:
+    FrontEndPolicy(size_t capacity, const Policy& policy) : cache_(capacity, policy) {}
+
+    bool Access(trace_key_t key) override {
+        if (cache_.get(key).has_value()) return true;
+        cache_.put(key, key);
+        return false;
+    }
+
+    size_t Size() const override { return cache_.size(); }
+};
+
+/** @brief PolicySpec for LRUCache. */
+inline PolicySpec LRUPolicySpec() {
+    return {"LRU", [](size_t capacity) { return std::make_unique<LRUCachePolicy>(capacity); }};
+}
+
+/** @brief PolicySpec for FixedLRU. */
+inline PolicySpec FixedLRUPolicySpec() {
+    return {"FixedLRU", [](size_t capacity) { return std::make_unique<FixedLRUPolicy>(capacity); }};
+}
+
+/** @brief PolicySpec for LRU_K_Cache with the given K. */
+inline PolicySpec LRUKPolicySpec(size_t k) {
+    return {"LRU-" + std::to_string(k),
+            [k](size_t capacity) { return std::make_unique<LRUKCachePolicy>(capacity, k); }};
+}
+
+/**
+ * @brief PolicySpec for LRU_K_Cache retaining the histories of as many
+ *        evicted keys as `ghost_ratio` times the capacity, with the given
+ *        correlated reference period.
+ */
+inline PolicySpec LRUKRetainedPolicySpec(size_t k, double ghost_ratio, timestamp_t correlated_period) {
+    return {"LRU-" + std::to_string(k) + "+RIP",
+            [=](size_t capacity) {
+                return std::make_unique<LRUKCachePolicy>(
+                    capacity, k, static_cast<size_t>(capacity * ghost_ratio), correlated_period);
+            }};
+}
+
+/** @brief PolicySpec for LRFUCache with the given decay rate per simulated second. */
+inline PolicySpec LRFUPolicySpec(double lambda) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "LRFU(%g)", lambda);
+    return {name, [lambda](size_t capacity) { return std::make_unique<LRFUCachePolicy>(capacity, lambda); }};
+}
+
+/** @brief PolicySpec for Cache<..., Policy, Index> configured with `policy`. */
+template <typename Policy, typename Index = UnorderedIndex>
+PolicySpec FrontEndPolicySpec(std::string name, Policy policy = Policy()) {
+    return {std::move(name), [policy](size_t capacity) {
+                return std::make_unique<FrontEndPolicy<Policy, Index>>(capacity, policy);
+            }};
+}
+
+/* ------------------------------------------------------------------------ */
+/*                                Simulation                                */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Outcome of replaying one trace through one policy.
+ */
+struct SimulationResult {
+    std::string policy;          ///< Policy name.
+    size_t accesses = 0;         ///< Number of replayed accesses.
+    size_t hits = 0;             ///< Number of hits.
+    double seconds = 0.0;        ///< Wall-clock replay time.
+    size_t resident = 0;         ///< Entries resident at the end of the run.
+    long long heap_bytes = -1;   ///< Heap bytes held by the policy, -1 if unknown.
+
+    double HitRatio() const { return accesses == 0 ? 0.0 : static_cast<double>(hits) / accesses; }
+
+    double OpsPerSecond() const { return seconds <= 0.0 ? 0.0 : accesses / seconds; }
+
+    /** @brief Heap bytes per resident entry, or a negative value if unknown. */
+    double BytesPerEntry() const {
+        if (heap_bytes < 0 || resident == 0) return -1.0;
+        return static_cast<double>(heap_bytes) / resident;
+    }
+};
+
+/**
+ * @brief Returns the number of heap bytes currently held by the calling thread.
+ *
+ * The simulator cannot observe allocations by itself; a driver that replaces
+ * the global allocator can supply a probe so memory per entry is reported.
+ * Replays run one policy per thread, so a thread-local counter is sufficient.
+ */
+using HeapProbe = std::function<long long()>;
+
+/**
+ * @brief Replays a trace through a freshly built policy.
+ *
+ * @param spec The policy to run.
+ * @param trace The accesses to replay.
+ * @param capacity Cache capacity in entries.
+ * @param probe Optional heap probe for memory accounting.
+ */
+inline SimulationResult RunTrace(const PolicySpec& spec, const Trace& trace, size_t capacity,
+                                 const HeapProbe& probe = nullptr) {
+    SimulationResult result;
+    result.policy = spec.name;
+    result.accesses = trace.size();
+
+    long long heap_before = probe ? probe() : 0;
+    std::unique_ptr<CachePolicy> policy = spec.make(capacity);
+
+    auto start = std::chrono::steady_clock::now();
+    for (trace_key_t key : trace) {
+        if (policy->Access(key)) ++result.hits;
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+    result.resident = policy->Size();
+    if (probe) result.heap_bytes = probe() - heap_before;
+    return result;
+}
+
+/**
+ * @brief Replays the same trace through several policies, one thread each.
+ *
+ * The trace is shared read-only between threads. Results are returned in the
+ * order of @p specs.
+ */
+inline std::vector<SimulationResult> RunParallel(const std::vector<PolicySpec>& specs,
+                                                 const Trace& trace, size_t capacity,
+                                                 const HeapProbe& probe = nullptr) {
+    std::vector<SimulationResult> results(specs.size());
+    std::vector<std::exception_ptr> errors(specs.size());
+    std::vector<std::thread> workers;
+    workers.reserve(specs.size());
+
+    for (size_t i = 0; i < specs.size(); ++i) {
+        workers.emplace_back([&, i] {
+            try {
+                results[i] = RunTrace(specs[i], trace, capacity, probe);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    for (const std::exception_ptr& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+    return results;
+}
+
+} // namespace Collections::Simulation
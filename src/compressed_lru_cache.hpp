@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "lru_cache.hpp"
+#include "lz_codec.hpp"
+
+/**
+ * @file compressed_lru_cache.hpp
+ * @brief Byte-budgeted LRU cache that keeps cold values compressed.
+ */
+
+namespace Collections {
+
+/**
+ * @brief Configuration of a CompressedLRUCache.
+ */
+struct CompressedCacheOptions {
+    size_t byte_budget = 64u << 20;   ///< Bound on stored value bytes (compressed size for cold entries).
+    int hot_capacity = 256;           ///< Entries kept uncompressed in front.
+    size_t compress_threshold = 256;  ///< Values shorter than this are never compressed.
+    double min_savings = 0.125;       ///< Keep a compressed copy only if it saves this share.
+};
+
+/**
+ * @brief An LRU cache of byte-vector values with a compressed cold tier.
+ *
+ * The most recent entries sit uncompressed in a small hot LRUCache. Entries
+ * it evicts move to the cold LRUCache, compressed with LZCodec when they are
+ * at least compress_threshold bytes long and compression saves at least
+ * min_savings. A cold hit is decompressed and promoted back to the hot set.
+ *
+ * The budget counts value bytes as stored: uncompressed size in the hot set,
+ * compressed size in the cold tier. Least recently used cold entries are
+ * dropped first; the hot set only shrinks once the cold tier is empty.
+ *
+ * @tparam K Key type.
+ * @tparam Hash Hash functor for K.
+ */
+template <typename K, typename Hash = std::hash<K>>
+class CompressedLRUCache {
+public:
+    using Bytes = std::vector<uint8_t>;
+
+private:
+    /** @brief A cold value, compressed or not. */
+    struct Stored {
+        Bytes bytes;
+        size_t original_size;
+        bool compressed;
+    };
+
+    CompressedCacheOptions options_;
+    LZCodec codec_;
+    LRUCache<K, Bytes, Hash> hot_;
+    LRUCache<K, Stored, Hash> cold_;
+    size_t hot_bytes_ = 0;
+    size_t cold_bytes_ = 0;
+    size_t cold_original_bytes_ = 0;
+
+    Stored Pack(Bytes value) {
+        size_t size = value.size();
+        if (size >= options_.compress_threshold) {
+            Bytes packed = codec_.Compress(value);
+            if (packed.size() <= size - static_cast<size_t>(size * options_.min_savings))
+                return {std::move(packed), size, true};
+        }
+        return {std::move(value), size, false};
+    }
+
+    Bytes Unpack(Stored stored) const {
+        if (!stored.compressed) return std::move(stored.bytes);
+        std::optional<Bytes> bytes = LZCodec::Decompress(stored.bytes, stored.original_size);
+        if (!bytes.has_value())
+            throw std::runtime_error("CompressedLRUCache: corrupt compressed value");
+        return std::move(*bytes);
+    }
+
+    void Demote(K&& key, Bytes&& value) {
+        hot_bytes_ -= value.size();
+        Stored stored = Pack(std::move(value));
+        cold_bytes_ += stored.bytes.size();
+        cold_original_bytes_ += stored.original_size;
+        cold_.put(std::move(key), std::move(stored));
+    }
+
+    void ForgetCold(const Stored& stored) {
+        cold_bytes_ -= stored.bytes.size();
+        cold_original_bytes_ -= stored.original_size;
+    }
+
+    void EnforceBudget() {
+        while (hot_bytes_ + cold_bytes_ > options_.byte_budget) {
+            if (auto victim = cold_.pop_lru()) {
+                ForgetCold(victim->second);
+            } else if (auto hot_victim = hot_.pop_lru()) {
+                hot_bytes_ -= hot_victim->second.size();
+            } else {
+                break;
+            }
+        }
+    }
+
+public:
+    explicit CompressedLRUCache(CompressedCacheOptions options = {})
+        : options_(options),
+          hot_(options.hot_capacity),
+          cold_(std::numeric_limits<int>::max()) {
+        if (options_.hot_capacity <= 0)
+            throw std::invalid_argument("CompressedLRUCache hot capacity must be positive");
+        hot_.set_eviction_listener(
+            [this](K&& key, Bytes&& value, bool) { Demote(std::move(key), std::move(value)); });
+        hot_.set_removal_listener([this](K&&, Bytes&& value, bool) { hot_bytes_ -= value.size(); });
+        cold_.set_removal_listener([this](K&&, Stored&& stored, bool) { ForgetCold(stored); });
+    }
+
+    CompressedLRUCache(const CompressedLRUCache&) = delete;
+    CompressedLRUCache& operator=(const CompressedLRUCache&) = delete;
+
+    /**
+     * @brief Returns a copy of the value; cold hits are decompressed and promoted.
+     */
+    std::optional<Bytes> get(const K& key) {
+        std::optional<Bytes> value = hot_.get(key);
+        if (value.has_value()) return value;
+
+        std::optional<Stored> cold = cold_.take(key);
+        if (!cold.has_value()) return std::nullopt;
+        ForgetCold(*cold);
+
+        Bytes bytes = Unpack(std::move(*cold));
+        hot_bytes_ += bytes.size();
+        hot_.put(key, bytes);
+        EnforceBudget();
+        return bytes;
+    }
+
+    /**
+     * @brief Inserts or replaces a value in the hot set.
+     */
+    void put(K key, Bytes value) {
+        hot_.erase(key);
+        cold_.erase(key);
+        hot_bytes_ += value.size();
+        hot_.put(std::move(key), std::move(value));
+        EnforceBudget();
+    }
+
+    bool erase(const K& key) {
+        bool removed = hot_.erase(key);
+        return cold_.erase(key) || removed;
+    }
+
+    bool contains(const K& key) const { return hot_.contains(key) || cold_.contains(key); }
+
+    size_t size() const { return hot_.size() + cold_.size(); }
+
+    size_t hot_size() const { return hot_.size(); }
+
+    size_t cold_size() const { return cold_.size(); }
+
+    /** @brief Value bytes charged against the budget. */
+    size_t stored_bytes() const { return hot_bytes_ + cold_bytes_; }
+
+    /** @brief Value bytes the cached entries would take uncompressed. */
+    size_t logical_bytes() const { return hot_bytes_ + cold_original_bytes_; }
+
+    size_t byte_budget() const { return options_.byte_budget; }
+};
+
+} // namespace Collections
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+#include "epoch_reclamation.hpp"
+
+/**
+ * @file concurrent_lru_cache.hpp
+ * @brief Thread-safe LRU cache whose reads never take a lock.
+ */
+
+namespace Collections {
+
+/**
+ * @brief A concurrent LRU cache with a lock-free read path.
+ *
+ * The design follows Caffeine:
+ *  - The hash index is an array of buckets holding atomic singly linked
+ *    chains. Writers (put/erase/eviction) serialize on one mutex and publish
+ *    with release stores; readers traverse with acquire loads while pinned in
+ *    the global EpochDomain, so unlinked entries stay allocated until no
+ *    reader can reach them.
+ *  - Entries are immutable once published; put() on an existing key links a
+ *    replacement entry and retires the old one.
+ *  - get() does not touch the recency list. It records the hit in one of
+ *    several striped ring buffers. The buffers are lossy: when one is full
+ *    the access is simply dropped, which only costs recency precision. They
+ *    are replayed into the LRU list in batches by whichever thread holds the
+ *    writer lock, either a writer or a reader that wins a try_lock when its
+ *    buffer passes the drain threshold.
+ *
+ * Reads of a single hot key therefore only write to the reader's own epoch
+ * record and, usually, to a buffer stripe chosen per thread.
+ *
+ * @tparam K Key type.
+ * @tparam V Value type (copied out on every hit).
+ * @tparam Hash Hash functor for K.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+    requires std::equality_comparable<K> && std::copy_constructible<V>
+class ConcurrentLRUCache {
+private:
+    /** @brief Intrusive recency links; the sentinel is a bare Link. */
+    struct Link {
+        Link* prev = nullptr;
+        Link* next = nullptr;
+    };
+
+    /** @brief A published key-value pair. */
+    struct Entry : Link {
+        const K key;
+        const V value;
+        const size_t hash;
+        std::atomic<Entry*> chain_next{nullptr};  ///< Next entry in the bucket.
+        bool retired = false;                     ///< Unlinked; writer lock only.
+
+        Entry(K k, V v, size_t h) : key(std::move(k)), value(std::move(v)), hash(h) {}
+    };
+
+    static constexpr size_t kBufferSlots = 32;          ///< Per stripe, power of two.
+    static constexpr size_t kDrainThreshold = kBufferSlots / 2;
+    static constexpr size_t kReclaimBatch = 64;         ///< Retired entries per reclaim attempt.
+
+    /** @brief One lossy multi-producer ring of recorded reads. */
+    struct alignas(64) ReadBuffer {
+        std::atomic<uint64_t> write{0};
+        std::atomic<uint64_t> read{0};
+        std::atomic<Entry*> slots[kBufferSlots] = {};
+    };
+
+    size_t capacity_;
+    Hash hasher_;
+    size_t bucket_mask_;
+    std::unique_ptr<std::atomic<Entry*>[]> buckets_;
+    size_t stripe_mask_;
+    std::unique_ptr<ReadBuffer[]> read_buffers_;
+
+    std::mutex writer_;                     ///< Guards everything below.
+    Link head_;                             ///< head_.next is most recent.
+    std::atomic<size_t> size_{0};
+    RetireList<Entry> retired_;
+
+    std::atomic<Entry*>& BucketOf(size_t hash) const { return buckets_[hash & bucket_mask_]; }
+
+    ReadBuffer& LocalBuffer() const {
+        thread_local const size_t probe = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return read_buffers_[probe & stripe_mask_];
+    }
+
+    template <typename Q>
+    Entry* Find(const Q& key, size_t hash) const {
+        for (Entry* e = BucketOf(hash).load(std::memory_order_acquire); e != nullptr;
+             e = e->chain_next.load(std::memory_order_acquire)) {
+            if (e->hash == hash && e->key == key) return e;
+        }
+        return nullptr;
+    }
+
+    /* ----------------------- writer-lock helpers ----------------------- */
+
+    void Unlink(Link* node) {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+    }
+
+    void PushFront(Link* node) {
+        node->prev = &head_;
+        node->next = head_.next;
+        head_.next->prev = node;
+        head_.next = node;
+    }
+
+    /**
+     * @brief Removes an entry from its bucket chain and hands it to the retire list.
+     */
+    void RemoveFromIndex(Entry* entry) {
+        std::atomic<Entry*>* link = &BucketOf(entry->hash);
+        while (link->load(std::memory_order_relaxed) != entry)
+            link = &link->load(std::memory_order_relaxed)->chain_next;
+        link->store(entry->chain_next.load(std::memory_order_relaxed), std::memory_order_release);
+        Unlink(entry);
+        entry->retired = true;
+        retired_.Retire(entry);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Replays recorded reads into the LRU list.
+     *
+     * @return False if a slot was claimed but not yet filled, in which case
+     *         later slots of that stripe were left for the next drain.
+     */
+    bool DrainReadBuffers() {
+        bool complete = true;
+        for (size_t s = 0; s <= stripe_mask_; ++s) {
+            ReadBuffer& buffer = read_buffers_[s];
+            uint64_t read = buffer.read.load(std::memory_order_relaxed);
+            uint64_t write = buffer.write.load(std::memory_order_acquire);
+            for (; read < write; ++read) {
+                Entry* entry = buffer.slots[read & (kBufferSlots - 1)].exchange(nullptr, std::memory_order_acquire);
+                if (entry == nullptr) {
+                    complete = false;
+                    break;
+                }
+                if (!entry->retired) {
+                    Unlink(entry);
+                    PushFront(entry);
+                }
+            }
+            buffer.read.store(read, std::memory_order_release);
+        }
+        return complete;
+    }
+
+    /**
+     * @brief Frees retired entries whose grace period has elapsed.
+     *
+     * A buffered pointer may only refer to an entry that its reader found
+     * while pinned, so after the safe epoch is read and every buffer is fully
+     * drained no stale pointer to a reclaimable entry can remain.
+     */
+    void Reclaim() {
+        uint64_t safe = EpochDomain::Global().SafeEpoch();
+        if (DrainReadBuffers()) retired_.Reclaim(safe);
+    }
+
+    void MaybeReclaim() {
+        if (retired_.size() >= kReclaimBatch) Reclaim();
+    }
+
+    void RecordRead(Entry* entry) {
+        ReadBuffer& buffer = LocalBuffer();
+        uint64_t write = buffer.write.load(std::memory_order_relaxed);
+        uint64_t pending = write - buffer.read.load(std::memory_order_acquire);
+        if (pending < kBufferSlots &&
+            buffer.write.compare_exchange_strong(write, write + 1, std::memory_order_acq_rel)) {
+            buffer.slots[write & (kBufferSlots - 1)].store(entry, std::memory_order_release);
+            ++pending;
+        }
+        if (pending >= kDrainThreshold && writer_.try_lock()) {
+            DrainReadBuffers();
+            writer_.unlock();
+        }
+    }
+
+public:
+    /**
+     * @brief Creates an empty cache.
+     *
+     * @param capacity Maximum number of entries.
+     * @param stripes Number of read buffers; rounded up to a power of two.
+     *        Defaults to four per hardware thread.
+     */
+    explicit ConcurrentLRUCache(size_t capacity, size_t stripes = 0)
+        : capacity_(capacity),
+          bucket_mask_(std::bit_ceil(std::max<size_t>(capacity, 1)) - 1),
+          buckets_(new std::atomic<Entry*>[bucket_mask_ + 1]),
+          stripe_mask_(std::bit_ceil(stripes != 0 ? stripes
+                                                  : 4 * std::max(1u, std::thread::hardware_concurrency())) - 1),
+          read_buffers_(new ReadBuffer[stripe_mask_ + 1]) {
+        if (capacity_ == 0) throw std::invalid_argument("ConcurrentLRUCache capacity must be positive");
+        for (size_t i = 0; i <= bucket_mask_; ++i) buckets_[i].store(nullptr, std::memory_order_relaxed);
+        head_.prev = head_.next = &head_;
+    }
+
+    ConcurrentLRUCache(const ConcurrentLRUCache&) = delete;
+    ConcurrentLRUCache& operator=(const ConcurrentLRUCache&) = delete;
+
+    /**
+     * @brief Frees every entry. No other thread may be using the cache.
+     */
+    ~ConcurrentLRUCache() {
+        for (Link* node = head_.next; node != &head_;) {
+            Link* next = node->next;
+            delete static_cast<Entry*>(node);
+            node = next;
+        }
+    }
+
+    /**
+     * @brief Lock-free lookup.
+     *
+     * @return A copy of the value, or std::nullopt on a miss.
+     */
+    std::optional<V> get(const K& key) {
+        auto guard = EpochDomain::Global().Pin();
+        Entry* entry = Find(key, hasher_(key));
+        if (entry == nullptr) return std::nullopt;
+        std::optional<V> value(entry->value);
+        RecordRead(entry);
+        return value;
+    }
+
+    /**
+     * @brief Lock-free membership test; does not count as an access.
+     */
+    bool contains(const K& key) const {
+        auto guard = EpochDomain::Global().Pin();
+        return Find(key, hasher_(key)) != nullptr;
+    }
+
+    /**
+     * @brief Inserts or replaces a value, evicting the least recently used
+     *        entry if the cache is full.
+     */
+    void put(K key, V value) {
+        size_t hash = hasher_(key);
+        Entry* fresh = new Entry(std::move(key), std::move(value), hash);
+
+        std::lock_guard<std::mutex> lock(writer_);
+        DrainReadBuffers();
+
+        std::atomic<Entry*>* link = &BucketOf(hash);
+        Entry* current = link->load(std::memory_order_relaxed);
+        while (current != nullptr && !(current->hash == hash && current->key == fresh->key)) {
+            link = &current->chain_next;
+            current = link->load(std::memory_order_relaxed);
+        }
+
+        if (current != nullptr) {
+            fresh->chain_next.store(current->chain_next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            link->store(fresh, std::memory_order_release);
+            Unlink(current);
+            current->retired = true;
+            retired_.Retire(current);
+        } else {
+            // Evict first, so concurrent size() calls never see capacity + 1.
+            if (size_.load(std::memory_order_relaxed) >= capacity_)
+                RemoveFromIndex(static_cast<Entry*>(head_.prev));
+            std::atomic<Entry*>& bucket = BucketOf(hash);
+            fresh->chain_next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            bucket.store(fresh, std::memory_order_release);
+            size_.fetch_add(1, std::memory_order_relaxed);
+        }
+        PushFront(fresh);
+        MaybeReclaim();
+    }
+
+    /**
+     * @brief Removes a key.
+     * @return True if the key was present.
+     */
+    bool erase(const K& key) {
+        size_t hash = hasher_(key);
+        std::lock_guard<std::mutex> lock(writer_);
+        Entry* entry = Find(key, hash);
+        if (entry == nullptr) return false;
+        RemoveFromIndex(entry);
+        MaybeReclaim();
+        return true;
+    }
+
+    /**
+     * @brief Applies pending reads and frees retired entries when possible.
+     */
+    void maintenance() {
+        std::lock_guard<std::mutex> lock(writer_);
+        Reclaim();
+    }
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    size_t capacity() const { return capacity_; }
+};
+
+} // namespace Collections
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * @file epoch_reclamation.hpp
+ * @brief Epoch-based memory reclamation for lock-free readers.
+ *
+ * Readers pin the current epoch while they hold raw pointers into a shared
+ * structure. A writer that unlinks an object retires it with the epoch at
+ * unlink time; the object is freed only once every pinned reader has moved
+ * past that epoch, so no reader can still be dereferencing it.
+ */
+
+namespace Collections {
+
+/**
+ * @brief Registry of reader epochs shared by every lock-free structure.
+ *
+ * Each thread owns one cache-line-sized record. Records are recycled when
+ * threads exit and are never freed, so scanning them is always safe.
+ */
+class EpochDomain {
+private:
+    /** @brief Per-thread state, padded to avoid false sharing. */
+    struct alignas(64) ThreadRecord {
+        std::atomic<uint64_t> epoch{0};     ///< Pinned epoch, 0 when quiescent.
+        std::atomic<bool> in_use{false};    ///< Owned by a live thread.
+        uint32_t nesting = 0;               ///< Pin depth, owner thread only.
+        ThreadRecord* next = nullptr;       ///< Immutable once published.
+    };
+
+    /** @brief Releases the calling thread's record when the thread exits. */
+    struct RecordOwner {
+        ThreadRecord* record = nullptr;
+        ~RecordOwner() {
+            if (record != nullptr) record->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    std::atomic<uint64_t> global_epoch_{1};
+    std::atomic<ThreadRecord*> records_{nullptr};
+
+    EpochDomain() = default;
+
+    ThreadRecord* AcquireRecord() {
+        for (ThreadRecord* r = records_.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+            bool expected = false;
+            if (!r->in_use.load(std::memory_order_relaxed) &&
+                r->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                return r;
+            }
+        }
+        ThreadRecord* record = new ThreadRecord();
+        record->in_use.store(true, std::memory_order_relaxed);
+        ThreadRecord* head = records_.load(std::memory_order_relaxed);
+        do {
+            record->next = head;
+        } while (!records_.compare_exchange_weak(head, record, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+        return record;
+    }
+
+    ThreadRecord* LocalRecord() {
+        thread_local RecordOwner owner;
+        if (owner.record == nullptr) owner.record = AcquireRecord();
+        return owner.record;
+    }
+
+public:
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    /**
+     * @brief The process-wide domain.
+     */
+    static EpochDomain& Global() {
+        static EpochDomain* domain = new EpochDomain();  // intentionally leaked
+        return *domain;
+    }
+
+    /**
+     * @brief RAII pin: while alive, objects reachable at pin time stay allocated.
+     *
+     * Pins nest; only the outermost guard publishes and clears the epoch.
+     */
+    class Guard {
+    private:
+        ThreadRecord* record_;
+
+    public:
+        Guard(const EpochDomain& domain, ThreadRecord* record) : record_(record) {
+            if (record_->nesting++ == 0) {
+                record_->epoch.store(domain.global_epoch_.load(), std::memory_order_seq_cst);
+                // Order the announcement before any load of the protected structure.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        ~Guard() {
+            if (--record_->nesting == 0) record_->epoch.store(0, std::memory_order_release);
+        }
+    };
+
+    /**
+     * @brief Pins the calling thread in the current epoch.
+     */
+    Guard Pin() { return Guard(*this, LocalRecord()); }
+
+    /**
+     * @brief Advances the global epoch and returns the epoch it replaced.
+     *
+     * Objects unlinked before this call should be retired with the returned value.
+     */
+    uint64_t Advance() { return global_epoch_.fetch_add(1, std::memory_order_seq_cst); }
+
+    /**
+     * @brief Objects retired with an epoch strictly below this value can be freed.
+     */
+    uint64_t SafeEpoch() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t safe = global_epoch_.load(std::memory_order_seq_cst);
+        for (ThreadRecord* r = records_.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+            uint64_t pinned = r->epoch.load(std::memory_order_seq_cst);
+            if (pinned != 0 && pinned < safe) safe = pinned;
+        }
+        return safe;
+    }
+};
+
+/**
+ * @brief Objects waiting for their grace period, owned by a single writer.
+ *
+ * Not thread-safe: callers serialize Retire() and Reclaim() themselves,
+ * typically under the structure's writer lock.
+ *
+ * @tparam T Type of the retired objects.
+ */
+template <typename T>
+class RetireList {
+private:
+    std::vector<std::pair<T*, uint64_t>> retired_;
+    std::function<void(T*)> deleter_;
+
+public:
+    explicit RetireList(std::function<void(T*)> deleter = [](T* object) { delete object; })
+        : deleter_(std::move(deleter)) {}
+
+    RetireList(const RetireList&) = delete;
+    RetireList& operator=(const RetireList&) = delete;
+
+    /**
+     * @brief Frees everything immediately; readers must be gone.
+     */
+    ~RetireList() {
+        for (auto& [object, _] : retired_) deleter_(object);
+    }
+
+    /**
+     * @brief Schedules an already unlinked object for deletion.
+     */
+    void Retire(T* object, EpochDomain& domain = EpochDomain::Global()) {
+        retired_.emplace_back(object, domain.Advance());
+    }
+
+    /**
+     * @brief Frees every object whose grace period has elapsed.
+     *
+     * @param safe_epoch Value of EpochDomain::SafeEpoch() observed by the caller.
+     * @return Number of objects freed.
+     */
+    size_t Reclaim(uint64_t safe_epoch) {
+        size_t kept = 0;
+        for (size_t i = 0; i < retired_.size(); ++i) {
+            if (retired_[i].second < safe_epoch) {
+                deleter_(retired_[i].first);
+            } else {
+                retired_[kept++] = retired_[i];
+            }
+        }
+        size_t freed = retired_.size() - kept;
+        retired_.resize(kept);
+        return freed;
+    }
+
+    size_t size() const { return retired_.size(); }
+};
+
+} // namespace Collections
@@ -0,0 +1,685 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "transparent_hash.hpp"
+
+/**
+ * @file flat_hash_map.hpp
+ * @brief Open-addressing hash map with SIMD group probing.
+ */
+
+namespace Collections {
+
+namespace detail {
+
+/** @brief Control byte: the 7-bit H2 tag of a full slot, or kEmptyCtrl. */
+using ctrl_t = int8_t;
+
+inline constexpr ctrl_t kEmptyCtrl = -128;
+
+#if defined(__SSE2__)
+
+/**
+ * @brief Sixteen control bytes compared at once with SSE2.
+ */
+struct ProbeGroup {
+    using Mask = uint32_t;
+    static constexpr size_t kWidth = 16;
+
+    __m128i ctrl_;
+
+    explicit ProbeGroup(const ctrl_t* ctrl) : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+    /** @brief Slots whose tag equals h2, one bit per slot. */
+    Mask Match(uint8_t h2) const {
+        return static_cast<Mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(h2)), ctrl_)));
+    }
+
+    /** @brief Empty slots; only kEmptyCtrl has the sign bit set. */
+    Mask MatchEmpty() const { return static_cast<Mask>(_mm_movemask_epi8(ctrl_)); }
+
+    static size_t Index(Mask bits) { return static_cast<size_t>(std::countr_zero(bits)); }
+};
+
+#else
+
+/**
+ * @brief Portable fallback: eight control bytes compared in one 64-bit word.
+ *
+ * Match() may report a false positive next to a true match; callers compare
+ * keys anyway.
+ */
+struct ProbeGroup {
+    using Mask = uint64_t;
+    static constexpr size_t kWidth = 8;
+    static constexpr uint64_t kLsbs = 0x0101010101010101ULL;
+    static constexpr uint64_t kMsbs = 0x8080808080808080ULL;
+
+    uint64_t ctrl_ = 0;
+
+    explicit ProbeGroup(const ctrl_t* ctrl) {
+        for (size_t i = 0; i < kWidth; ++i) ctrl_ |= uint64_t{static_cast<uint8_t>(ctrl[i])} << (8 * i);
+    }
+
+    Mask Match(uint8_t h2) const {
+        uint64_t x = ctrl_ ^ (kLsbs * h2);
+        return (x - kLsbs) & ~x & kMsbs;
+    }
+
+    Mask MatchEmpty() const { return ctrl_ & kMsbs; }
+
+    static size_t Index(Mask bits) { return static_cast<size_t>(std::countr_zero(bits)) >> 3; }
+};
+
+#endif
+
+} // namespace detail
+
+/**
+ * @brief An open-addressing hash map in the style of Swiss tables.
+ *
+ * A parallel array of control bytes holds a 7-bit tag of each key's hash.
+ * A lookup loads ProbeGroup::kWidth control bytes starting at the key's home
+ * slot and compares them all against the tag in one SSE2 instruction, or in
+ * one 64-bit word without SSE2. It compares keys only for matching tags.
+ * Probing is linear by slot. The control array repeats its first
+ * kWidth - 1 bytes after the end, so a group may start at any slot.
+ *
+ * Erase uses backward shift instead of tombstones: later members of the
+ * cluster move back into the hole. Lookups therefore always stop at the
+ * first empty slot, and the table never degrades under churn. The table
+ * doubles when it would exceed a 7/8 load factor.
+ *
+ * Entries live inline in one array, so a rehash or an erase can move them.
+ * Any insertion invalidates iterators, pointers and references; an erase
+ * invalidates those to later elements of the same cluster. Because of the
+ * shift, erase(iterator) returns nothing. Use erase_if() to filter while
+ * iterating. Slots hold the pair with a non-const key internally, so an
+ * entry that moves has its key moved, not copied.
+ *
+ * A rehash builds the new arrays before it touches the old ones. If moving
+ * an entry may throw, entries are copied instead and the old table is kept
+ * until every copy succeeded, so a failed rehash leaves the map unchanged.
+ * Hash must not throw.
+ *
+ * With transparent Hash and KeyEqual (see transparent_hash.hpp), find(),
+ * contains(), count() and erase() accept any key type the functors accept.
+ *
+ * @tparam K Key type.
+ * @tparam V Mapped type.
+ * @tparam Hash Hash functor, may be transparent.
+ * @tparam KeyEqual Equality functor, may be transparent.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class FlatHashMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+
+private:
+    /**
+     * @brief Storage of one entry.
+     *
+     * Users see `value`; moves go through `mutable_value`, whose key is not
+     * const. Both members have the same layout, as in other Swiss tables.
+     */
+    union Slot {
+        value_type value;
+        std::pair<K, V> mutable_value;
+
+        Slot() {}
+        ~Slot() {}
+    };
+
+public:
+    /**
+     * @brief Forward iterator over full slots.
+     */
+    template <bool Const>
+    class Iterator {
+    private:
+        friend class FlatHashMap;
+
+        using Slot = std::conditional_t<Const, const FlatHashMap::Slot, FlatHashMap::Slot>;
+        using Value = std::conditional_t<Const, const FlatHashMap::value_type, FlatHashMap::value_type>;
+
+        const detail::ctrl_t* ctrl_ = nullptr;
+        const detail::ctrl_t* end_ = nullptr;
+        Slot* slot_ = nullptr;
+
+        Iterator(const detail::ctrl_t* ctrl, const detail::ctrl_t* end, Slot* slot)
+            : ctrl_(ctrl), end_(end), slot_(slot) {}
+
+        void SkipEmpty() {
+            while (ctrl_ != end_ && *ctrl_ == detail::kEmptyCtrl) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        Iterator() = default;
+
+        /** @brief Converts an iterator to a const_iterator. */
+        template <bool OtherConst>
+            requires(Const && !OtherConst)
+        Iterator(const Iterator<OtherConst>& other) : ctrl_(other.ctrl_), end_(other.end_), slot_(other.slot_) {}
+
+        reference operator*() const { return slot_->value; }
+        pointer operator->() const { return &slot_->value; }
+
+        Iterator& operator++() {
+            ++ctrl_;
+            ++slot_;
+            SkipEmpty();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.ctrl_ == b.ctrl_; }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+private:
+    using Group = detail::ProbeGroup;
+
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+    detail::ctrl_t* ctrl_ = nullptr;  ///< capacity_ + Group::kWidth - 1 bytes.
+    Slot* slots_ = nullptr;
+    size_t capacity_ = 0;             ///< Zero or a power of two >= Group::kWidth.
+    size_t size_ = 0;
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] KeyEqual equal_;
+
+    static size_t MaxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+    /** @brief Smallest valid capacity holding `count` entries. */
+    static size_t CapacityFor(size_t count) {
+        size_t capacity = Group::kWidth;
+        while (MaxLoad(capacity) < count) capacity *= 2;
+        return capacity;
+    }
+
+    size_t Mask() const { return capacity_ - 1; }
+
+    /** @brief Spreads the user hash so low-entropy hashes (e.g. identity) probe well. */
+    template <typename Q>
+    size_t HashOf(const Q& key) const {
+        uint64_t h = static_cast<uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    static size_t H1(size_t hash) { return hash >> 7; }
+    static uint8_t H2(size_t hash) { return static_cast<uint8_t>(hash & 0x7F); }
+
+    static void SetCtrl(detail::ctrl_t* ctrl, size_t capacity, size_t index, detail::ctrl_t value) {
+        ctrl[index] = value;
+        if (index < Group::kWidth - 1) ctrl[capacity + index] = value;
+    }
+
+    void SetCtrl(size_t index, detail::ctrl_t value) { SetCtrl(ctrl_, capacity_, index, value); }
+
+    /** @brief Moves (or, when a move may throw, copies) an entry into raw storage. */
+    static void Relocate(Slot* to, Slot* from) {
+        if constexpr (std::is_nothrow_move_constructible_v<std::pair<K, V>>) {
+            std::construct_at(&to->mutable_value, std::move(from->mutable_value));
+        } else {
+            std::construct_at(&to->value, std::as_const(from->value));
+        }
+    }
+
+    /** @brief Moves an entry within a table; the source slot becomes raw. */
+    static void MoveSlot(Slot* to, Slot* from) {
+        std::construct_at(&to->mutable_value, std::move(from->mutable_value));
+        std::destroy_at(&from->mutable_value);
+    }
+
+    template <typename Q>
+    size_t FindIndex(const Q& key, size_t hash) const {
+        if (capacity_ == 0) return kNotFound;
+        size_t pos = H1(hash) & Mask();
+        uint8_t tag = H2(hash);
+        while (true) {
+            Group group(ctrl_ + pos);
+            for (auto bits = group.Match(tag); bits != 0; bits &= bits - 1) {
+                size_t index = (pos + Group::Index(bits)) & Mask();
+                if (equal_(slots_[index].value.first, key)) return index;
+            }
+            if (group.MatchEmpty() != 0) return kNotFound;
+            pos = (pos + Group::kWidth) & Mask();
+        }
+    }
+
+    /** @brief First empty slot at or after the home of `hash`; there is always one. */
+    static size_t FindEmpty(const detail::ctrl_t* ctrl, size_t capacity, size_t hash) {
+        size_t mask = capacity - 1;
+        size_t pos = H1(hash) & mask;
+        while (true) {
+            auto empty = Group(ctrl + pos).MatchEmpty();
+            if (empty != 0) return (pos + Group::Index(empty)) & mask;
+            pos = (pos + Group::kWidth) & mask;
+        }
+    }
+
+    size_t FindEmpty(size_t hash) const { return FindEmpty(ctrl_, capacity_, hash); }
+
+    /** @brief Destroys the entries of a table and frees its arrays. */
+    static void FreeTable(detail::ctrl_t* ctrl, Slot* slots, size_t capacity) {
+        for (size_t i = 0; i < capacity; ++i) {
+            if (ctrl[i] != detail::kEmptyCtrl) std::destroy_at(&slots[i].value);
+        }
+        std::allocator<Slot>().deallocate(slots, capacity);
+        delete[] ctrl;
+    }
+
+    /**
+     * @brief Moves every entry into new arrays of `capacity` slots.
+     *
+     * The new table is committed only once it holds every entry; if an
+     * allocation or a copy throws, it is freed and the map is unchanged.
+     */
+    void Resize(size_t capacity) {
+        std::unique_ptr<detail::ctrl_t[]> ctrl(new detail::ctrl_t[capacity + Group::kWidth - 1]);
+        std::memset(ctrl.get(), static_cast<uint8_t>(detail::kEmptyCtrl), capacity + Group::kWidth - 1);
+        Slot* slots = std::allocator<Slot>().allocate(capacity);
+
+        try {
+            for (size_t i = 0; i < capacity_; ++i) {
+                if (ctrl_[i] == detail::kEmptyCtrl) continue;
+                size_t hash = HashOf(slots_[i].value.first);
+                size_t index = FindEmpty(ctrl.get(), capacity, hash);
+                Relocate(slots + index, slots_ + i);
+                SetCtrl(ctrl.get(), capacity, index, static_cast<detail::ctrl_t>(H2(hash)));
+            }
+        } catch (...) {
+            FreeTable(ctrl.release(), slots, capacity);
+            throw;
+        }
+
+        if (capacity_ != 0) FreeTable(ctrl_, slots_, capacity_);
+        ctrl_ = ctrl.release();
+        slots_ = slots;
+        capacity_ = capacity;
+    }
+
+    /** @brief Constructs an entry for a key known to be absent. */
+    template <typename... Args>
+    size_t InsertNew(size_t hash, Args&&... args) {
+        if (size_ + 1 > MaxLoad(capacity_)) {
+            Resize(capacity_ == 0 ? Group::kWidth : capacity_ * 2);
+        }
+        size_t index = FindEmpty(hash);
+        std::construct_at(&slots_[index].mutable_value, std::forward<Args>(args)...);
+        SetCtrl(index, static_cast<detail::ctrl_t>(H2(hash)));
+        ++size_;
+        return index;
+    }
+
+    /**
+     * @brief Destroys the entry at `index` and shifts the rest of its cluster back.
+     *
+     * An entry moves into the hole when the hole lies between its home slot
+     * and its current slot, which keeps every entry reachable from its home.
+     */
+    void EraseAt(size_t index) {
+        std::destroy_at(&slots_[index].value);
+        --size_;
+        size_t hole = index;
+        for (size_t j = (index + 1) & Mask(); ctrl_[j] != detail::kEmptyCtrl; j = (j + 1) & Mask()) {
+            size_t home = H1(HashOf(slots_[j].value.first)) & Mask();
+            if (((j - home) & Mask()) >= ((j - hole) & Mask())) {
+                MoveSlot(slots_ + hole, slots_ + j);
+                SetCtrl(hole, ctrl_[j]);
+                hole = j;
+            }
+        }
+        SetCtrl(hole, detail::kEmptyCtrl);
+    }
+
+    void DestroyAll() {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (ctrl_[i] != detail::kEmptyCtrl) std::destroy_at(&slots_[i].value);
+        }
+    }
+
+    void Release() {
+        if (capacity_ == 0) return;
+        FreeTable(ctrl_, slots_, capacity_);
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+        capacity_ = 0;
+        size_ = 0;
+    }
+
+    iterator IteratorAt(size_t index) { return {ctrl_ + index, ctrl_ + capacity_, slots_ + index}; }
+
+    const_iterator IteratorAt(size_t index) const { return {ctrl_ + index, ctrl_ + capacity_, slots_ + index}; }
+
+public:
+    FlatHashMap() = default;
+
+    /**
+     * @brief Creates an empty map with room for `count` entries.
+     */
+    explicit FlatHashMap(size_t count, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+        : hash_(hash), equal_(equal) {
+        reserve(count);
+    }
+
+    FlatHashMap(std::initializer_list<value_type> values) { insert_range(values); }
+
+    /**
+     * @brief Copies the entries of `other`.
+     *
+     * Delegates, so the map is fully constructed before any value is copied:
+     * if a copy throws, the destructor frees the table and the copies made.
+     */
+    FlatHashMap(const FlatHashMap& other) : FlatHashMap(other.size_, other.hash_, other.equal_) {
+        for (const value_type& value : other) InsertNew(HashOf(value.first), value);
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept
+        : ctrl_(std::exchange(other.ctrl_, nullptr)),
+          slots_(std::exchange(other.slots_, nullptr)),
+          capacity_(std::exchange(other.capacity_, 0)),
+          size_(std::exchange(other.size_, 0)),
+          hash_(std::move(other.hash_)),
+          equal_(std::move(other.equal_)) {}
+
+    FlatHashMap& operator=(const FlatHashMap& other) {
+        if (this != &other) {
+            FlatHashMap copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+        if (this != &other) {
+            Release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~FlatHashMap() { Release(); }
+
+    void swap(FlatHashMap& other) noexcept {
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(slots_, other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(hash_, other.hash_);
+        std::swap(equal_, other.equal_);
+    }
+
+    iterator begin() {
+        iterator it = IteratorAt(0);
+        it.SkipEmpty();
+        return it;
+    }
+
+    const_iterator begin() const {
+        const_iterator it = IteratorAt(0);
+        it.SkipEmpty();
+        return it;
+    }
+
+    iterator end() { return IteratorAt(capacity_); }
+    const_iterator end() const { return IteratorAt(capacity_); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /** @brief Number of slots. */
+    size_t bucket_count() const { return capacity_; }
+
+    float load_factor() const { return capacity_ == 0 ? 0.0f : static_cast<float>(size_) / capacity_; }
+
+    float max_load_factor() const { return 0.875f; }
+
+    hasher hash_function() const { return hash_; }
+    key_equal key_eq() const { return equal_; }
+
+    /**
+     * @brief Makes room for `count` entries without further rehashing.
+     */
+    void reserve(size_t count) {
+        if (count > MaxLoad(capacity_)) Resize(CapacityFor(count));
+    }
+
+    /**
+     * @brief Rebuilds the table with at least `count` slots, shrinking if
+     *        the entries allow.
+     */
+    void rehash(size_t count) {
+        size_t capacity = std::max(CapacityFor(size_), std::bit_ceil(std::max(count, Group::kWidth)));
+        if (size_ == 0 && count == 0) {
+            Release();
+        } else if (capacity != capacity_) {
+            Resize(capacity);
+        }
+    }
+
+    /**
+     * @brief Destroys every entry and keeps the slots.
+     */
+    void clear() {
+        if (capacity_ == 0) return;
+        DestroyAll();
+        std::memset(ctrl_, static_cast<uint8_t>(detail::kEmptyCtrl), capacity_ + Group::kWidth - 1);
+        size_ = 0;
+    }
+
+    iterator find(const K& key) {
+        size_t index = FindIndex(key, HashOf(key));
+        return index == kNotFound ? end() : IteratorAt(index);
+    }
+
+    const_iterator find(const K& key) const {
+        size_t index = FindIndex(key, HashOf(key));
+        return index == kNotFound ? end() : IteratorAt(index);
+    }
+
+    template <typename Q>
+        requires TransparentLookup<Hash, KeyEqual>
+    iterator find(const Q& key) {
+        size_t index = FindIndex(key, HashOf(key));
+        return index == kNotFound ? end() : IteratorAt(index);
+    }
+
+    template <typename Q>
+        requires TransparentLookup<Hash, KeyEqual>
+    const_iterator find(const Q& key) const {
+        size_t index = FindIndex(key, HashOf(key));
+        return index == kNotFound ? end() : IteratorAt(index);
+    }
+
+    bool contains(const K& key) const { return FindIndex(key, HashOf(key)) != kNotFound; }
+
+    template <typename Q>
+        requires TransparentLookup<Hash, KeyEqual>
+    bool contains(const Q& key) const {
+        return FindIndex(key, HashOf(key)) != kNotFound;
+    }
+
+    size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    template <typename Q>
+        requires TransparentLookup<Hash, KeyEqual>
+    size_t count(const Q& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    V& at(const K& key) {
+        size_t index = FindIndex(key, HashOf(key));
+        if (index == kNotFound) throw std::out_of_range("FlatHashMap::at: key not found");
+        return slots_[index].value.second;
+    }
+
+    const V& at(const K& key) const {
+        size_t index = FindIndex(key, HashOf(key));
+        if (index == kNotFound) throw std::out_of_range("FlatHashMap::at: key not found");
+        return slots_[index].value.second;
+    }
+
+    V& operator[](const K& key) { return try_emplace(key).first->second; }
+
+    V& operator[](K&& key) { return try_emplace(std::move(key)).first->second; }
+
+    /**
+     * @brief Inserts a value constructed from `args` unless the key exists.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        size_t hash = HashOf(key);
+        size_t index = FindIndex(key, hash);
+        if (index != kNotFound) return {IteratorAt(index), false};
+        index = InsertNew(hash, std::piecewise_construct, std::forward_as_tuple(key),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+        return {IteratorAt(index), true};
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        size_t hash = HashOf(key);
+        size_t index = FindIndex(key, hash);
+        if (index != kNotFound) return {IteratorAt(index), false};
+        index = InsertNew(hash, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+        return {IteratorAt(index), true};
+    }
+
+    /**
+     * @brief Inserts a pair built from `args` unless its key exists.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        std::pair<K, V> value(std::forward<Args>(args)...);
+        size_t hash = HashOf(value.first);
+        size_t index = FindIndex(value.first, hash);
+        if (index != kNotFound) return {IteratorAt(index), false};
+        return {IteratorAt(InsertNew(hash, std::move(value))), true};
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+
+    std::pair<iterator, bool> insert(value_type&& value) { return emplace(std::move(value)); }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(K key, M&& mapped) {
+        auto [it, inserted] = try_emplace(std::move(key), std::forward<M>(mapped));
+        if (!inserted) it->second = std::forward<M>(mapped);
+        return {it, inserted};
+    }
+
+    template <std::input_iterator It>
+    void insert(It first, It last) {
+        if constexpr (std::forward_iterator<It>) reserve(size_ + static_cast<size_t>(std::distance(first, last)));
+        for (; first != last; ++first) emplace(*first);
+    }
+
+    /**
+     * @brief Inserts every pair of a range, reserving once when its size is known.
+     *
+     * Keys already present keep their values, as with insert().
+     */
+    template <std::ranges::input_range R>
+    void insert_range(R&& range) {
+        if constexpr (std::ranges::sized_range<R>) reserve(size_ + std::ranges::size(range));
+        for (auto&& value : range) emplace(std::forward<decltype(value)>(value));
+    }
+
+    /**
+     * @brief Removes a key.
+     * @return The number of entries removed, 0 or 1.
+     */
+    size_t erase(const K& key) {
+        size_t index = FindIndex(key, HashOf(key));
+        if (index == kNotFound) return 0;
+        EraseAt(index);
+        return 1;
+    }
+
+    template <typename Q>
+        requires TransparentLookup<Hash, KeyEqual>
+    size_t erase(const Q& key) {
+        size_t index = FindIndex(key, HashOf(key));
+        if (index == kNotFound) return 0;
+        EraseAt(index);
+        return 1;
+    }
+
+    /**
+     * @brief Removes the entry at `pos`; later entries of its cluster may move.
+     */
+    void erase(const_iterator pos) { EraseAt(static_cast<size_t>(pos.ctrl_ - ctrl_)); }
+
+    void erase(iterator pos) { EraseAt(static_cast<size_t>(pos.ctrl_ - ctrl_)); }
+
+    /**
+     * @brief Removes every entry for which `pred(entry)` holds.
+     *
+     * The scan starts just after an empty slot. Entries never shift across an
+     * empty slot, so every entry is tested exactly once.
+     *
+     * @return The number of entries removed.
+     */
+    template <typename Pred>
+    size_t erase_if(Pred pred) {
+        if (size_ == 0) return 0;
+        size_t start = 0;
+        while (ctrl_[start] != detail::kEmptyCtrl) ++start;
+        size_t removed = 0;
+        for (size_t step = 1; step <= capacity_;) {
+            size_t index = (start + step) & Mask();
+            if (ctrl_[index] != detail::kEmptyCtrl && pred(std::as_const(slots_[index].value))) {
+                EraseAt(index);  // may pull an untested entry into index
+                ++removed;
+            } else {
+                ++step;
+            }
+        }
+        return removed;
+    }
+};
+
+} // namespace Collections
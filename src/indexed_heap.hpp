@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @file indexed_heap.hpp
+ * @brief A d-ary min-heap whose elements know their own position.
+ */
+
+namespace Collections {
+
+/**
+ * @brief Min-heap of handles supporting erase and re-prioritization in O(log n).
+ *
+ * Each handle stores its current heap position through the PositionOf
+ * functor, so an element can be located without searching. Handles are
+ * usually node pointers (position kept in the node) or dense integer ids
+ * (position kept in a side array). The heap is 4-ary: shallower than a
+ * binary heap and a parent's children share a cache line when T is small.
+ *
+ * Nothing is allocated per operation once the backing vector has grown.
+ * Handles start out of the heap: their position slot must hold npos.
+ *
+ * @tparam T Handle type (cheap to copy).
+ * @tparam Less Strict weak ordering on handles; the smallest is on top.
+ * @tparam PositionOf Functor returning a `size_t&` slot for a handle's position.
+ */
+template <typename T, typename Less, typename PositionOf>
+class IndexedHeap {
+private:
+    static constexpr size_t kArity = 4;
+
+    std::vector<T> heap_;
+    Less less_;
+    PositionOf position_;
+
+    void Place(size_t index, T value) {
+        position_(value) = index;
+        heap_[index] = std::move(value);
+    }
+
+    void SiftUp(size_t index) {
+        T value = heap_[index];
+        while (index > 0) {
+            size_t parent = (index - 1) / kArity;
+            if (!less_(value, heap_[parent])) break;
+            Place(index, heap_[parent]);
+            index = parent;
+        }
+        Place(index, value);
+    }
+
+    void SiftDown(size_t index) {
+        T value = heap_[index];
+        const size_t size = heap_.size();
+        while (true) {
+            size_t first = index * kArity + 1;
+            if (first >= size) break;
+            size_t best = first;
+            size_t last = std::min(first + kArity, size);
+            for (size_t child = first + 1; child < last; ++child) {
+                if (less_(heap_[child], heap_[best])) best = child;
+            }
+            if (!less_(heap_[best], value)) break;
+            Place(index, heap_[best]);
+            index = best;
+        }
+        Place(index, value);
+    }
+
+public:
+    /** @brief Position reported for handles that are not in the heap. */
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    explicit IndexedHeap(Less less = Less(), PositionOf position = PositionOf())
+        : less_(std::move(less)), position_(std::move(position)) {}
+
+    /**
+     * @brief Adds a handle that is not yet in the heap.
+     */
+    void push(T value) {
+        heap_.push_back(value);
+        position_(value) = heap_.size() - 1;
+        SiftUp(heap_.size() - 1);
+    }
+
+    /**
+     * @brief Returns the smallest handle. The heap must not be empty.
+     */
+    const T& top() const { return heap_.front(); }
+
+    /**
+     * @brief Removes the smallest handle.
+     */
+    void pop() { erase(heap_.front()); }
+
+    /**
+     * @brief Removes a handle that is in the heap; its position becomes npos.
+     */
+    void erase(T value) {
+        size_t index = position_(value);
+        position_(value) = npos;
+        T last = heap_.back();
+        heap_.pop_back();
+        if (index == heap_.size()) return;
+        Place(index, last);
+        update(last);
+    }
+
+    /**
+     * @brief Restores heap order after a handle's priority changed.
+     */
+    void update(T value) {
+        size_t index = position_(value);
+        if (index > 0 && less_(heap_[index], heap_[(index - 1) / kArity])) {
+            SiftUp(index);
+        } else {
+            SiftDown(index);
+        }
+    }
+
+    /**
+     * @brief True if the handle is currently in the heap.
+     */
+    bool contains(T value) const { return const_cast<PositionOf&>(position_)(value) != npos; }
+
+    void reserve(size_t capacity) { heap_.reserve(capacity); }
+
+    void clear() {
+        for (T& value : heap_) position_(value) = npos;
+        heap_.clear();
+    }
+
+    bool empty() const { return heap_.empty(); }
+
+    size_t size() const { return heap_.size(); }
+};
+
+} // namespace Collections
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "indexed_heap.hpp"
+
+/**
+ * @file lrfu_cache.hpp
+ * @brief Cache evicting by exponentially decayed recency-frequency (LRFU).
+ */
+
+namespace Collections {
+
+/**
+ * @brief An LRFU cache: every access adds to a score that decays with time.
+ *
+ * Each entry has a Combined Recency and Frequency value
+ *
+ *     CRF(t) = sum over its accesses t_i of 2^(-lambda * (t - t_i)),
+ *
+ * with t in seconds from an injectable clock. lambda = 0 counts accesses
+ * (LFU); a large lambda makes the last access dominate (LRU). The entry
+ * with the smallest CRF is evicted.
+ *
+ * Since every CRF decays by the same factor, the cache stores the
+ * time-independent key log2 CRF(t_last) + lambda * (t_last - base) and never
+ * touches an entry it does not access. The keys live in an IndexedHeap, so
+ * an access and an eviction are O(log n). The keys grow with time; once
+ * lambda * (now - base) passes kRebaseSpan, every key is shifted down by the
+ * same amount and base moves to now, which keeps their precision.
+ *
+ * Not thread-safe.
+ *
+ * @tparam K Key type.
+ * @tparam V Value type.
+ * @tparam Hash Hash functor for K.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class LRFUCache {
+public:
+    using clock_type = std::function<std::chrono::steady_clock::time_point()>;
+
+private:
+    struct Entry {
+        K key_;
+        V value_;
+        double score_;  ///< log2 CRF at the last access plus lambda * (last access - base).
+        size_t heap_index_ = std::numeric_limits<size_t>::max();
+
+        Entry(K key, V value, double score) : key_(std::move(key)), value_(std::move(value)), score_(score) {}
+    };
+
+    struct Less {
+        bool operator()(const Entry* a, const Entry* b) const { return a->score_ < b->score_; }
+    };
+
+    struct HeapIndexOf {
+        size_t& operator()(Entry* entry) const { return entry->heap_index_; }
+    };
+
+    /** @brief Decay, in halvings, after which all keys are rebased. */
+    static constexpr double kRebaseSpan = 1u << 20;
+
+    size_t capacity_;
+    double lambda_;
+    clock_type now_;
+    std::chrono::steady_clock::time_point origin_;  ///< Clock reading at construction.
+    double base_ = 0.0;                             ///< Seconds from origin_ that keys are relative to.
+    double last_ = 0.0;                             ///< Latest time seen; the clock may not go back.
+    std::unordered_map<K, Entry*, Hash> index_;
+    IndexedHeap<Entry*, Less, HeapIndexOf> heap_;
+
+    /** @brief Reads the clock as seconds from origin_, rebasing keys when due. */
+    double Now() {
+        double t = std::chrono::duration<double>(now_() - origin_).count();
+        if (t > last_) last_ = t;
+        double decay = lambda_ * (last_ - base_);
+        if (decay > kRebaseSpan) {
+            for (auto& [_, entry] : index_) entry->score_ -= decay;
+            base_ = last_;
+        }
+        return last_;
+    }
+
+    /** @brief Adds an access at time t to an entry's key. */
+    void Touch(Entry* entry, double t) {
+        double elapsed = lambda_ * (t - base_);
+        double crf = entry->score_ - elapsed;  // log2 CRF now, before this access
+        // log2(1 + 2^crf), computed without overflow either way.
+        double updated = crf > 0 ? crf + std::log2(1.0 + std::exp2(-crf)) : std::log2(1.0 + std::exp2(crf));
+        entry->score_ = updated + elapsed;
+        heap_.update(entry);
+    }
+
+public:
+    /**
+     * @brief Creates an empty cache.
+     *
+     * @param capacity Maximum number of entries.
+     * @param lambda Decay rate: a past access counts half as much every
+     *        1 / lambda seconds. 0 gives LFU.
+     * @param clock Time source; steady_clock by default.
+     */
+    explicit LRFUCache(size_t capacity, double lambda, clock_type clock = nullptr)
+        : capacity_(capacity),
+          lambda_(lambda),
+          now_(clock ? std::move(clock) : clock_type([] { return std::chrono::steady_clock::now(); })),
+          origin_(now_()) {
+        if (capacity_ == 0) throw std::invalid_argument("LRFUCache capacity must be positive");
+        if (!(lambda_ >= 0.0) || std::isinf(lambda_))
+            throw std::invalid_argument("LRFUCache lambda must be finite and non-negative");
+        heap_.reserve(capacity_);
+    }
+
+    LRFUCache(const LRFUCache&) = delete;
+    LRFUCache& operator=(const LRFUCache&) = delete;
+
+    ~LRFUCache() {
+        for (auto& [_, entry] : index_) delete entry;
+    }
+
+    /**
+     * @brief Returns a copy of the value and records the access.
+     */
+    std::optional<V> get(const K& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) return std::nullopt;
+        Touch(it->second, Now());
+        return it->second->value_;
+    }
+
+    /**
+     * @brief Inserts or replaces a value; both count as an access.
+     *
+     * A new key evicts the entry with the smallest CRF first when the cache
+     * is full, so it is never its own victim.
+     */
+    void put(K key, V value) {
+        double t = Now();
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            it->second->value_ = std::move(value);
+            Touch(it->second, t);
+            return;
+        }
+        if (index_.size() >= capacity_) {
+            Entry* victim = heap_.top();
+            heap_.pop();
+            index_.erase(victim->key_);
+            delete victim;
+        }
+        // A first access has CRF 1, whose log is 0.
+        Entry* entry = new Entry(std::move(key), std::move(value), lambda_ * (t - base_));
+        index_.emplace(entry->key_, entry);
+        heap_.push(entry);
+    }
+
+    bool erase(const K& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) return false;
+        Entry* entry = it->second;
+        heap_.erase(entry);
+        index_.erase(it);
+        delete entry;
+        return true;
+    }
+
+    /** @brief Membership test; does not count as an access. */
+    bool contains(const K& key) const { return index_.find(key) != index_.end(); }
+
+    /**
+     * @brief Returns the current CRF of a key, or std::nullopt if it is not cached.
+     */
+    std::optional<double> crf(const K& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) return std::nullopt;
+        double t = Now();
+        return std::exp2(it->second->score_ - lambda_ * (t - base_));
+    }
+
+    size_t size() const { return index_.size(); }
+
+    size_t capacity() const { return capacity_; }
+
+    double lambda() const { return lambda_; }
+};
+
+} // namespace Collections
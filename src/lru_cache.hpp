@@ -1,17 +1,69 @@
 #ifndef LRU_CACHE
 #define LRU_CACHE
 
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <optional>
-#include <unordered_map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flat_hash_map.hpp"
+#include "serialization.hpp"
+#include "transparent_hash.hpp"
 
 namespace Collections {
 
+// On-disk layout of an LRUCache snapshot: this header followed by
+// `entry_count` (key, value) records, most recently used first (roughly, for
+// an incremental snapshot; see begin_snapshot()).
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t entry_count;
+  uint64_t payload_checksum;  // FNV-1a over every byte after the header
+  uint64_t header_checksum;   // FNV-1a over the fields above
+
+  static constexpr char kMagic[8] = {'L', 'R', 'U', 'S', 'N', 'A', 'P', '\0'};
+  static constexpr uint32_t kVersion = 1;
+
+  uint64_t compute_checksum() const {
+    Fnv1a64 checksum;
+    checksum.update(this, offsetof(SnapshotHeader, header_checksum));
+    return checksum.digest();
+  }
+
+  bool valid() const {
+    return std::memcmp(magic, kMagic, sizeof(kMagic)) == 0 && version == kVersion &&
+           header_checksum == compute_checksum();
+  }
+};
+
+enum class SnapshotStatus { kInProgress, kDone, kFailed };
+
 template <typename K, typename V>
 struct Node {
   std::optional<K> key;
   std::optional<V> value;
   Node* next;
   Node* prev;
+  // Write-back state: dirty nodes are also linked in insertion order on a
+  // second list so flush_dirty() never scans clean entries.
+  bool dirty = false;
+  Node* dirty_next = nullptr;
+  Node* dirty_prev = nullptr;
+  // Epoch of the last snapshot that wrote this node.
+  uint32_t snapshot_epoch = 0;
 
   Node()
       : next(nullptr), prev(nullptr), key(std::nullopt), value(std::nullopt) {}
@@ -23,14 +75,45 @@ struct Node {
         prev(nullptr) {}
 };
 
-template <typename K, typename V>
-  requires std::equality_comparable<K> && requires(K k) { std::hash<K>{}(k); }
+// Hash and KeyEqual may be transparent (see transparent_hash.hpp); get(),
+// contains() and erase() then accept any key type the functors accept,
+// including Prehashed keys carrying a hash computed upstream.
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+  requires std::predicate<const KeyEqual&, const K&, const K&> &&
+           requires(const Hash& h, const K& k) {
+             { h(k) } -> std::convertible_to<size_t>;
+           }
 class LRUCache {
  private:
+  // Entries evicted per operation while the cache is above its capacity
+  // after set_capacity() shrank it.
+  static constexpr size_t kEvictionsPerOperation = 8;
+
   int _capacity;
-  std::unordered_map<K, Node<K, V>*> _cache_mapper;
+  FlatHashMap<K, Node<K, V>*, Hash, KeyEqual> _cache_mapper;
   Node<K, V>* _head;
   Node<K, V>* _tail;
+  // Listeners receive the key and value by move plus the entry's dirty bit.
+  std::function<void(K&&, V&&, bool)> _eviction_listener;
+  std::function<void(K&&, V&&, bool)> _removal_listener;
+  Node<K, V>* _dirty_first = nullptr;
+  Node<K, V>* _dirty_last = nullptr;
+  size_t _dirty_count = 0;
+
+  struct SnapshotState {
+    std::ofstream out;
+    std::string path;
+    std::string temp_path;
+    uint64_t entry_count = 0;
+    std::unique_ptr<ChecksumWriter> writer;
+  };
+  std::unique_ptr<SnapshotState> _snapshot;
+  // Last node written by the in-progress snapshot; nullptr when idle.
+  Node<K, V>* _snapshot_cursor = nullptr;
+  // Incremented by every begin_snapshot(); nodes written by the current
+  // snapshot carry this value.
+  uint32_t _snapshot_epoch = 0;
 
   void add(Node<K, V>* node) {  // Time O(1) , Space O(1)
     Node<K, V>* head_next = _head->next;
@@ -43,12 +126,94 @@ class LRUCache {
     node2->prev = node1;
   }
 
+  void add_back(Node<K, V>* node) {  // Time O(1) , Space O(1)
+    Node<K, V>* tail_prev = _tail->prev;
+    link(tail_prev, node);
+    link(node, _tail);
+  }
+
   void remove(Node<K, V>* node) {  // Time O(1) , Space O(1)
+    if (node == _snapshot_cursor) {
+      _snapshot_cursor = node->prev;  // keep the snapshot walk on live nodes
+    }
     Node<K, V>* prev_node = node->prev;
     Node<K, V>* next_node = node->next;
     link(prev_node, next_node);  // link them together to avoid null dereference
   }
 
+  // Moves a node to the front. During a snapshot a node that the walk has
+  // not reached yet is written first, since it would otherwise land behind
+  // the cursor and be skipped.
+  void promote(Node<K, V>* node) {  // Time O(1) , Space O(1)
+    snapshot_before_promote(node);
+    remove(node);
+    add(node);
+  }
+
+  void snapshot_before_promote(Node<K, V>* node) {
+    if constexpr (Serializable<K> && Serializable<V>) {
+      if (_snapshot && node->snapshot_epoch != _snapshot_epoch) {
+        write_snapshot_entry(node);
+      }
+    }
+  }
+
+  void write_snapshot_entry(Node<K, V>* node)
+    requires Serializable<K> && Serializable<V>
+  {
+    Codec<K>::Write(*_snapshot->writer, node->key.value());
+    Codec<V>::Write(*_snapshot->writer, node->value.value());
+    _snapshot->entry_count++;
+    node->snapshot_epoch = _snapshot_epoch;
+  }
+
+  void mark_dirty_node(Node<K, V>* node) {  // Time O(1) , Space O(1)
+    if (node->dirty) return;
+    node->dirty = true;
+    node->dirty_prev = _dirty_last;
+    node->dirty_next = nullptr;
+    if (_dirty_last != nullptr) {
+      _dirty_last->dirty_next = node;
+    } else {
+      _dirty_first = node;
+    }
+    _dirty_last = node;
+    _dirty_count++;
+  }
+
+  void unlink_dirty(Node<K, V>* node) {  // Time O(1) , Space O(1)
+    if (!node->dirty) return;
+    if (node->dirty_prev != nullptr) {
+      node->dirty_prev->dirty_next = node->dirty_next;
+    } else {
+      _dirty_first = node->dirty_next;
+    }
+    if (node->dirty_next != nullptr) {
+      node->dirty_next->dirty_prev = node->dirty_prev;
+    } else {
+      _dirty_last = node->dirty_prev;
+    }
+    node->dirty_next = node->dirty_prev = nullptr;
+    _dirty_count--;
+  }
+
+  // Unlinks the node from every list and the index, hands it to `listener`
+  // and frees it. If the listener throws, the entry is still dropped and
+  // freed before the exception propagates.
+  void discard(typename FlatHashMap<K, Node<K, V>*, Hash, KeyEqual>::iterator it,
+               const std::function<void(K&&, V&&, bool)>& listener) {
+    std::unique_ptr<Node<K, V>> owned(it->second);
+    Node<K, V>* node = owned.get();
+    _cache_mapper.erase(it);
+    remove(node);
+    bool dirty = node->dirty;
+    unlink_dirty(node);
+    if (listener) {
+      listener(std::move(node->key.value()), std::move(node->value.value()),
+               dirty);
+    }
+  }
+
  public:
   LRUCache(int capacity) : _capacity(capacity) {
     _head = new Node<K, V>();  // dummy nodes
@@ -57,6 +222,7 @@ class LRUCache {
   }
 
   ~LRUCache() {  // Time O(capacity=n)
+    abort_snapshot();
     Node<K, V>* curr = _head;
     while (curr != nullptr) {
       Node<K, V>* next = curr->next;
@@ -65,35 +231,316 @@ class LRUCache {
     }
   }
 
-  void put(K key, V value) {  // Time O(1) , Space O(1)
-    if (_cache_mapper.find(key) != _cache_mapper.end()) {
-      Node<K, V>* old_node = _cache_mapper[key];
-      remove(old_node);
-      delete old_node;
+  // A dirty put marks the entry as modified until flush_dirty() writes it
+  // back; a clean put over a dirty entry keeps it dirty.
+  void put(K key, V value, bool dirty = false) {  // Time O(1) , Space O(1)
+    auto it = _cache_mapper.find(key);
+    if (it != _cache_mapper.end()) {
+      Node<K, V>* node = it->second;
+      node->value = std::move(value);
+      if (dirty) mark_dirty_node(node);
+      promote(node);
+      return;
     }
 
-    Node<K, V>* new_node = new Node<K, V>(key, value);
-    _cache_mapper[key] = new_node;
+    Node<K, V>* new_node = new Node<K, V>(key, std::move(value));
+    _cache_mapper.emplace(std::move(key), new_node);
+    snapshot_before_promote(new_node);
     add(new_node);
+    if (dirty) mark_dirty_node(new_node);
+
+    evict_step(kEvictionsPerOperation);
+  }
+
+  // Returns the value and makes the entry the most recently used. Like put(),
+  // a get() also runs evict_step() while the cache is above a capacity that
+  // set_capacity() shrank, so a read may call the eviction listener and
+  // propagate its exception instead of returning the value.
+  std::optional<V> get(const K& key) {  // Time O(1) , Space O(1)
+    std::optional<V> value = find_and_touch(key);
+    evict_step(kEvictionsPerOperation);
+    return value;
+  }
+
+  template <typename Q>
+    requires TransparentLookup<Hash, KeyEqual>
+  std::optional<V> get(const Q& key) {  // Time O(1) , Space O(1)
+    std::optional<V> value = find_and_touch(key);
+    evict_step(kEvictionsPerOperation);
+    return value;
+  }
+
+  bool contains(const K& key) const {  // Time O(1)
+    return _cache_mapper.find(key) != _cache_mapper.end();
+  }
+
+  template <typename Q>
+    requires TransparentLookup<Hash, KeyEqual>
+  bool contains(const Q& key) const {  // Time O(1)
+    return _cache_mapper.find(key) != _cache_mapper.end();
+  }
+
+  bool erase(const K& key) { return erase_key(key); }  // Time O(1)
+
+  template <typename Q>
+    requires TransparentLookup<Hash, KeyEqual>
+  bool erase(const Q& key) {  // Time O(1)
+    return erase_key(key);
+  }
+
+  Hash hash_function() const { return _cache_mapper.hash_function(); }
+
+  size_t size() const { return _cache_mapper.size(); }  // Time O(1)
 
-    if (_cache_mapper.size() > _capacity) {
-      Node<K, V>* tail_prev = _tail->prev;
-      remove(tail_prev);
-      if (tail_prev->key.has_value()) {
-        _cache_mapper.erase(tail_prev->key.value());
+  int capacity() const { return _capacity; }  // Time O(1)
+
+  // Growing takes effect immediately. Shrinking only lowers the limit: the
+  // excess is evicted a few entries at a time by later put()/get() calls or
+  // by evict_step(), so a memory-pressure hook can call this from any point
+  // that may hold the cache without causing a latency spike.
+  void set_capacity(int capacity) {  // Time O(1)
+    if (capacity <= 0) {
+      throw std::invalid_argument("LRUCache capacity must be positive");
+    }
+    _capacity = capacity;
+  }
+
+  // Evicts up to `budget` least recently used entries while the cache is
+  // above its capacity. Returns the number evicted.
+  size_t evict_step(size_t budget) {  // Time O(budget)
+    size_t evicted = 0;
+    while (evicted < budget &&
+           _cache_mapper.size() > static_cast<size_t>(_capacity)) {
+      discard(_cache_mapper.find(_tail->prev->key.value()), _eviction_listener);
+      evicted++;
+    }
+    return evicted;
+  }
+
+  // Removes and returns the least recently used entry without calling a
+  // listener; its dirty state is dropped.
+  std::optional<std::pair<K, V>> pop_lru() {  // Time O(1)
+    if (_cache_mapper.empty()) return std::nullopt;
+    std::optional<std::pair<K, V>> entry;
+    discard(_cache_mapper.find(_tail->prev->key.value()),
+            [&entry](K&& key, V&& value, bool) {
+              entry.emplace(std::move(key), std::move(value));
+            });
+    return entry;
+  }
+
+  // Removes and returns the value for a key without calling a listener; its
+  // dirty state is dropped. Unlike get() followed by erase(), the value is
+  // moved out rather than copied.
+  std::optional<V> take(const K& key) {  // Time O(1)
+    auto it = _cache_mapper.find(key);
+    if (it == _cache_mapper.end()) return std::nullopt;
+    std::optional<V> value;
+    discard(it, [&value](K&&, V&& v, bool) { value.emplace(std::move(v)); });
+    return value;
+  }
+
+  bool over_capacity() const {  // Time O(1)
+    return _cache_mapper.size() > static_cast<size_t>(_capacity);
+  }
+
+  // Called with every entry evicted by put() or get(). A dirty entry that is
+  // evicted without a listener is lost. An exception thrown by the listener
+  // propagates out of the evicting call; the entry is dropped.
+  void set_eviction_listener(std::function<void(K&&, V&&, bool)> listener) {
+    _eviction_listener = std::move(listener);
+  }
+
+  // Called with every entry removed by erase(), but not by take() or
+  // pop_lru(). An exception thrown by the listener propagates out of
+  // erase(); the entry is removed.
+  void set_removal_listener(std::function<void(K&&, V&&, bool)> listener) {
+    _removal_listener = std::move(listener);
+  }
+
+  bool mark_dirty(const K& key) {  // Time O(1)
+    auto it = _cache_mapper.find(key);
+    if (it == _cache_mapper.end()) return false;
+    mark_dirty_node(it->second);
+    return true;
+  }
+
+  size_t dirty_count() const { return _dirty_count; }  // Time O(1)
+
+  // Copies up to `max` dirty entries, oldest modification first, and marks
+  // them clean. With an external lock, call this under the lock and write
+  // the batch back after releasing it.
+  std::vector<std::pair<K, V>> take_dirty(size_t max) {  // Time O(max)
+    std::vector<std::pair<K, V>> batch;
+    batch.reserve(std::min(max, _dirty_count));
+    while (_dirty_first != nullptr && batch.size() < max) {
+      Node<K, V>* node = _dirty_first;
+      batch.emplace_back(node->key.value(), node->value.value());
+      unlink_dirty(node);
+      node->dirty = false;
+    }
+    return batch;
+  }
+
+  // Writes back up to `max` dirty entries with one call to `batch_fn`.
+  // If `batch_fn` throws, the entries still cached are marked dirty again.
+  template <typename BatchFn>
+    requires std::invocable<BatchFn&, std::vector<std::pair<K, V>>&>
+  size_t flush_dirty(BatchFn&& batch_fn, size_t max) {  // Time O(max)
+    std::vector<std::pair<K, V>> batch = take_dirty(max);
+    if (batch.empty()) return 0;
+    try {
+      batch_fn(batch);
+    } catch (...) {
+      for (const auto& entry : batch) mark_dirty(entry.first);
+      throw;
+    }
+    return batch.size();
+  }
+
+  // Writes every entry, most recently used first, to `path`. The file is
+  // written under a temporary name and renamed into place once complete.
+  bool save_snapshot(const std::string& path)  // Time O(n)
+    requires Serializable<K> && Serializable<V>
+  {
+    if (!begin_snapshot(path)) return false;
+    return snapshot_step(std::numeric_limits<size_t>::max()) ==
+           SnapshotStatus::kDone;
+  }
+
+  // Starts an incremental snapshot. Call snapshot_step() between regular
+  // operations until it returns kDone; each step only holds the cache for
+  // `budget` entries. The walk runs from the most recently used entry down.
+  // An entry inserted, or promoted before the walk reached it, is written
+  // at that moment, so every entry cached at the start and still cached at
+  // the end is saved exactly once. The saved order is then only roughly
+  // the recency order.
+  bool begin_snapshot(const std::string& path)  // Time O(1)
+    requires Serializable<K> && Serializable<V>
+  {
+    if (_snapshot) return false;
+    auto state = std::make_unique<SnapshotState>();
+    state->path = path;
+    state->temp_path = path + ".tmp";
+    state->out.open(state->temp_path, std::ios::binary | std::ios::trunc);
+    if (!state->out) return false;
+
+    SnapshotHeader placeholder{};
+    state->out.write(reinterpret_cast<const char*>(&placeholder),
+                     sizeof(placeholder));
+    state->writer = std::make_unique<ChecksumWriter>(state->out);
+    _snapshot = std::move(state);
+    _snapshot_cursor = _head;
+    _snapshot_epoch++;
+    return true;
+  }
+
+  SnapshotStatus snapshot_step(size_t budget)  // Time O(budget)
+    requires Serializable<K> && Serializable<V>
+  {
+    if (!_snapshot) return SnapshotStatus::kFailed;
+    while (budget > 0 && _snapshot_cursor->next != _tail) {
+      Node<K, V>* node = _snapshot_cursor->next;
+      if (node->snapshot_epoch != _snapshot_epoch) write_snapshot_entry(node);
+      _snapshot_cursor = node;
+      budget--;
+    }
+    if (!_snapshot->writer->good()) {
+      abort_snapshot();
+      return SnapshotStatus::kFailed;
+    }
+    if (_snapshot_cursor->next != _tail) return SnapshotStatus::kInProgress;
+    return finish_snapshot() ? SnapshotStatus::kDone : SnapshotStatus::kFailed;
+  }
+
+  bool snapshot_in_progress() const { return _snapshot != nullptr; }
+
+  // Drops an in-progress snapshot and its temporary file.
+  void abort_snapshot() {
+    if (!_snapshot) return;
+    _snapshot->out.close();
+    std::remove(_snapshot->temp_path.c_str());
+    _snapshot.reset();
+    _snapshot_cursor = nullptr;
+  }
+
+  // Verifies the checksums, then appends the snapshot entries behind the
+  // existing ones in their saved recency order until the cache is full.
+  // Keys that are already cached keep their current value.
+  bool load_snapshot(const std::string& path)  // Time O(n)
+    requires Serializable<K> && Serializable<V>
+  {
+    std::ifstream in(path, std::ios::binary);
+    SnapshotHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        !header.valid()) {
+      return false;
+    }
+
+    Fnv1a64 checksum;  // first pass: validate the payload before mutating
+    char buffer[1 << 14];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+      checksum.update(buffer, static_cast<size_t>(in.gcount()));
+    }
+    if (checksum.digest() != header.payload_checksum) return false;
+
+    in.clear();
+    in.seekg(sizeof(header));
+    StreamReader reader(in);
+    for (uint64_t i = 0; i < header.entry_count; i++) {
+      K key;
+      V value;
+      if (!Codec<K>::Read(reader, key) || !Codec<V>::Read(reader, value)) {
+        return false;
       }
-      delete tail_prev;
+      if (_cache_mapper.size() >= static_cast<size_t>(_capacity)) break;
+      if (_cache_mapper.find(key) != _cache_mapper.end()) continue;
+      Node<K, V>* node = new Node<K, V>(key, std::move(value));
+      _cache_mapper[std::move(key)] = node;
+      add_back(node);
     }
+    return true;
   }
 
-  std::optional<V> get(const K& key) {  // Time O(1) , Space O(1)
-    if (_cache_mapper.find(key) != _cache_mapper.end()) {
-      Node<K, V>* node = _cache_mapper[key];
-      remove(node);
-      add(node);
-      return node->value;
+ private:
+  template <typename Q>
+  std::optional<V> find_and_touch(const Q& key) {
+    auto it = _cache_mapper.find(key);
+    if (it == _cache_mapper.end()) return std::nullopt;
+    Node<K, V>* node = it->second;
+    promote(node);
+    return node->value;
+  }
+
+  template <typename Q>
+  bool erase_key(const Q& key) {
+    auto it = _cache_mapper.find(key);
+    if (it == _cache_mapper.end()) return false;
+    discard(it, _removal_listener);
+    return true;
+  }
+
+  bool finish_snapshot() {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SnapshotHeader::kMagic, sizeof(header.magic));
+    header.version = SnapshotHeader::kVersion;
+    header.entry_count = _snapshot->entry_count;
+    header.payload_checksum = _snapshot->writer->digest();
+    header.header_checksum = header.compute_checksum();
+
+    _snapshot->out.seekp(0);
+    _snapshot->out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _snapshot->out.close();
+    bool ok = !_snapshot->out.fail() &&
+              std::rename(_snapshot->temp_path.c_str(),
+                          _snapshot->path.c_str()) == 0;
+    if (!ok) {
+      abort_snapshot();
+      return false;
     }
-    return std::nullopt;
+    _snapshot.reset();
+    _snapshot_cursor = nullptr;
+    return true;
   }
 };
 }  // namespace Collections
@@ -1,13 +1,16 @@
 #pragma once
 
-#include <deque>
 #include <concepts>
 #include <cstdint>
 #include <functional>
+#include <limits>
+#include <mutex>
 #include <optional>
-#include <unordered_map>
-#include <set>
-#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "flat_hash_map.hpp"
+#include "lru_k_tracker.hpp"
 
 /**
  * @file lru_k_cache.h
@@ -16,11 +19,6 @@
 
 namespace Collections {
 
-#define THROW_RUNTIME(msg) throw std::runtime_error(msg)
-
-/** @brief Alias for the timestamp used in access history. */
-using timestamp_t = uint64_t;
-
 /**
  * @brief Concept ensuring a type is hashable and three-way comparable.
  */
@@ -32,20 +30,39 @@ concept HashableAndComparable = requires(T a) {
 /**
  * @brief A class implementing the LRU-K (Least Recently Used - K) Cache policy.
  * 
+ * Entries with fewer than K accesses have an infinite backward K-distance
+ * and are evicted first, in order of their first access; the others are
+ * ordered by their K-th most recent access. Put() always makes room first,
+ * so the size never exceeds the capacity. The bookkeeping is a
+ * detail::LRUKTracker, shared with Cache<..., LRUKPolicy<K>>, which evicts
+ * the same entries given the same operations and configuration.
+ *
+ * The access history of each entry is a ring of K timestamps stored inside
+ * the node when K is a compile-time constant.
+ *
+ * Two refinements from the LRU-K paper are opt-in. With retained history,
+ * the histories of recently evicted keys stay in a bounded ghost table, so a
+ * key that returns soon after eviction resumes with its old history instead
+ * of re-entering the sub-K class. With a correlated reference period, an
+ * access within that many ticks of the entry's previous access belongs to
+ * the same burst: it moves the most recent timestamp forward rather than
+ * adding a new one, so a burst counts as a single reference.
+ *
  * @tparam K Key type (must be hashable and comparable).
  * @tparam V Value type.
+ * @tparam HistoryDepth K fixed at compile time, or kRuntimeHistoryDepth to
+ *         pass it to the constructor (the history is then one allocation).
  */
-template<HashableAndComparable K, typename V>
+template<HashableAndComparable K, typename V, size_t HistoryDepth = kRuntimeHistoryDepth>
 class LRU_K_Cache {
 private:
     /**
      * @brief Internal structure representing a node in the cache.
      */
     struct LRUNode {
-        K key_;                          ///< The key of the entry.
-        V value_;                        ///< The associated value.
-        std::deque<timestamp_t> history_; ///< Timestamps of accesses.
-        bool is_evictable_;             ///< Indicates if the node is eligible for eviction.
+        K key_;                                   ///< The key of the entry.
+        V value_;                                 ///< The associated value.
+        detail::LRUKHook<HistoryDepth> hook_;     ///< Access history and eviction rank.
 
         /**
          * @brief Constructs a new LRUNode with perfect forwarding.
@@ -54,109 +71,88 @@ private:
          * @tparam ValueType Type of the value.
          * @param key The key of the entry.
          * @param value The value of the entry.
+         * @param k Number of accesses to track.
          */
         template<typename KeyType, typename ValueType>
-        LRUNode(KeyType&& key, ValueType&& value)
+        LRUNode(KeyType&& key, ValueType&& value, size_t k)
             : key_(std::forward<KeyType>(key)),
               value_(std::forward<ValueType>(value)),
-              is_evictable_(false) {}
+              hook_(k) {}
     };
 
     /**
-     * @brief Comparator for the eviction set. Sorts by oldest k-th timestamp.
+     * @brief Exposes a node's hook and key to the tracker.
      */
-    struct Compare {
-        int k_;
-
-        /**
-         * @brief Constructs a Compare object.
-         * @param k Number of accesses to track (K).
-         */
-        Compare(int k) : k_(k) {}
-
-        /**
-         * @brief Comparison function used by std::set.
-         */
-        bool operator()(const LRUNode* a, const LRUNode* b) const {
-            if (a->history_.size() < k_ && b->history_.size() < k_) {
-                return a->key_ < b->key_;
-            }
-            if (a->history_.size() < k_) return false;
-            if (b->history_.size() < k_) return true;
-            if (a->history_.front() == b->history_.front())
-                return a->key_ < b->key_;
-            return a->history_.front() < b->history_.front();
-        }
+    struct NodeTraits {
+        detail::LRUKHook<HistoryDepth>& hook(LRUNode* node) const { return node->hook_; }
+        const K& key(LRUNode* node) const { return node->key_; }
     };
 
+    /** @brief Nodes evicted per operation while above a shrunk capacity. */
+    static constexpr size_t kEvictionsPerOperation = 8;
+
     size_t capacity_;                          ///< Maximum number of entries.
-    size_t k_;                                 ///< Number of recent accesses to track.
-    std::unordered_map<K, LRUNode*> cache_;    ///< Main cache storage.
-    std::set<LRUNode*, Compare> eviction_set_; ///< Set of evictable entries.
-    timestamp_t current_timestamp_;            ///< Current timestamp.
+    FlatHashMap<K, LRUNode*> cache_;           ///< Main cache storage.
+    detail::LRUKTracker<LRUNode*, K, HistoryDepth, NodeTraits> tracker_; ///< Histories and eviction order.
 
     /**
-     * @brief Updates access history and eviction set after accessing a node.
-     * 
-     * @param node The accessed cache node.
+     * @brief Evicts nodes while the cache holds more than `target` entries.
+     *
+     * @param target Size to shrink to.
+     * @param budget Maximum number of nodes to evict.
+     * @return Number of nodes evicted.
      */
-    void ResourceAccess(LRUNode* node) {
-        if (current_timestamp_ == std::numeric_limits<timestamp_t>::max()) {
-            THROW_RUNTIME("Timestamp overflow in LRU-K Cache");
-        }
-
-        if (node->history_.size() == k_) {
-            eviction_set_.erase(node);
-        }
-
-        current_timestamp_++;
-        node->history_.push_back(current_timestamp_);
-        if (node->history_.size() > k_) {
-            node->history_.pop_front();
-        }
-
-        if (node->history_.size() == k_) {
-            if (!node->is_evictable_) {
-                node->is_evictable_ = true;
-            }
-
-            if (node->is_evictable_) {
-                eviction_set_.insert(node);
-            }
+    size_t EvictDownTo(size_t target, size_t budget) {
+        size_t evicted = 0;
+        while (evicted < budget && cache_.size() > target) {
+            LRUNode* node = tracker_.Victim();
+            tracker_.Dequeue(node);
+            cache_.erase(node->key_);
+            tracker_.Retain(node, std::move(node->key_));
+            delete node;
+            ++evicted;
         }
+        return evicted;
     }
 
     /**
-     * @brief Evicts the least recently used node if cache is at capacity.
+     * @brief Makes room for one insertion, also working off a shrink backlog.
      */
     void Evict() {
         if (cache_.size() < capacity_) return;
-
-        auto itr = eviction_set_.begin();
-        while (itr != eviction_set_.end()) {
-            LRUNode* node = *itr;
-            if (node->is_evictable_) {
-                eviction_set_.erase(itr);
-                cache_.erase(node->key_);
-                delete node;
-                break;
-            }
-            ++itr;
-        }
+        EvictDownTo(capacity_ - 1, kEvictionsPerOperation);
     }
 
 public:
+    /**
+     * @brief Constructs an LRU-K Cache whose K is its compile-time HistoryDepth.
+     *
+     * @param cache_size Maximum number of entries.
+     */
+    explicit LRU_K_Cache(size_t cache_size)
+        requires(HistoryDepth != kRuntimeHistoryDepth)
+        : LRU_K_Cache(cache_size, HistoryDepth) {}
+
     /**
      * @brief Constructs an LRU-K Cache with given capacity and K value.
      * 
-     * @param cache_size Maximum number of entries.
-     * @param k Number of recent accesses to track per key.
+     * @param cache_size Maximum number of entries; must be positive.
+     * @param k Number of recent accesses to track per key; must equal
+     *        HistoryDepth unless the depth is chosen at runtime.
      */
     LRU_K_Cache(size_t cache_size, size_t k)
         : capacity_(cache_size),
-          k_(k),
-          current_timestamp_(0),
-          eviction_set_(Compare(k)) {}
+          tracker_(k) {
+        if (capacity_ == 0) {
+            THROW_RUNTIME("LRU-K Cache capacity must be positive");
+        }
+        if (k == 0 || k > std::numeric_limits<uint32_t>::max()) {
+            THROW_RUNTIME("LRU-K Cache needs K >= 1");
+        }
+        if (HistoryDepth != kRuntimeHistoryDepth && k != HistoryDepth) {
+            THROW_RUNTIME("LRU-K Cache K does not match its HistoryDepth");
+        }
+    }
 
     /**
      * @brief Destroys the cache and releases allocated memory.
@@ -169,18 +165,24 @@ public:
 
     /**
      * @brief Retrieves the value associated with a key and updates access history.
+     *
+     * While the cache is above a capacity lowered by set_capacity(), this
+     * also evicts a few entries, as Put() does.
      * 
      * @param key The key to look for.
+     * @param type Access type hint; scans and prefetches are not recorded.
      * @return An optional containing the value if found, otherwise std::nullopt.
      */
-    std::optional<V> Get(const K& key) {
+    std::optional<V> Get(const K& key, AccessType type = AccessType::kUnknown) {
         if (cache_.find(key) == cache_.end()) {
             return std::nullopt;
         }
 
         LRUNode* node = cache_[key];
-        ResourceAccess(node);
-        return node->value_;
+        tracker_.Access(node, type);
+        std::optional<V> value = node->value_;
+        evict_step(kEvictionsPerOperation);
+        return value;
     }
 
     /**
@@ -188,18 +190,21 @@ public:
      * 
      * @param key The key to insert or update.
      * @param value The associated value.
+     * @param type Access type hint; a new entry from a scan is the next
+     *        victim and one from a prefetch starts without history.
      */
-    void Put(K&& key, V&& value) {
+    void Put(K&& key, V&& value, AccessType type = AccessType::kUnknown) {
         auto it = cache_.find(key);
         if (it != cache_.end()) {
             LRUNode* node = it->second;
-            ResourceAccess(node);
+            tracker_.Access(node, type);
             node->value_ = std::forward<V>(value);
         } else {
             Evict();
-            LRUNode* node = new LRUNode(std::forward<K>(key), std::forward<V>(value));
+            LRUNode* node = new LRUNode(std::forward<K>(key), std::forward<V>(value), tracker_.k());
             cache_[node->key_] = node;
-            ResourceAccess(node);
+            tracker_.Admit(node, type);
+            tracker_.Enqueue(node);
         }
     }
 
@@ -214,11 +219,7 @@ public:
         if (itr == cache_.end()) return false;
 
         LRUNode* node = itr->second;
-
-        if (node->history_.size() == k_ && node->is_evictable_) {
-            eviction_set_.erase(node);
-        }
-
+        tracker_.Dequeue(node);
         cache_.erase(itr);
         delete node;
         return true;
@@ -240,6 +241,227 @@ public:
      * @return Current cache size.
      */
     size_t size() const { return cache_.size(); }
+
+    /**
+     * @brief Returns the current capacity limit.
+     */
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Changes the capacity.
+     *
+     * Growing takes effect immediately. Shrinking only lowers the limit; the
+     * excess is evicted a few entries per later Get()/Put() or through
+     * evict_step(), so it is safe to call from a memory-pressure hook.
+     *
+     * @param capacity New maximum number of entries.
+     */
+    void set_capacity(size_t capacity) {
+        if (capacity == 0) {
+            THROW_RUNTIME("LRU-K Cache capacity must be positive");
+        }
+        capacity_ = capacity;
+    }
+
+    /**
+     * @brief Evicts up to `budget` entries while the cache is above its capacity.
+     *
+     * @param budget Maximum number of entries to evict.
+     * @return Number of entries evicted.
+     */
+    size_t evict_step(size_t budget) { return EvictDownTo(capacity_, budget); }
+
+    /**
+     * @brief Keeps the access histories of evicted keys (Retained Information Period).
+     *
+     * Replaces any existing ghost table. Remove() does not retain history.
+     *
+     * @param capacity Maximum number of ghosts, least recently evicted dropped
+     *        first; 0 disables retention.
+     * @param period Ghosts whose last access is more than this many ticks old
+     *        are discarded instead of resumed; 0 means no age limit.
+     */
+    void set_retained_history(size_t capacity, timestamp_t period = 0) {
+        tracker_.set_retained_history(capacity, period);
+    }
+
+    /**
+     * @brief Sets the Correlated Reference Period in ticks (accesses).
+     *
+     * @param period Accesses at most this many ticks after the previous
+     *        access to the same key count as one; 0 disables.
+     */
+    void set_correlated_reference_period(timestamp_t period) { tracker_.set_correlated_reference_period(period); }
+
+    /**
+     * @brief Returns the number of retained histories of evicted keys.
+     */
+    size_t ghost_size() const { return tracker_.ghost_size(); }
+};
+
+/** @brief Dense index of a buffer pool frame. */
+using frame_id_t = int32_t;
+
+/**
+ * @brief LRU-K replacement over a fixed set of buffer pool frames.
+ *
+ * Frames are dense ids in [0, num_frames), so all per-frame state lives in
+ * a flat array sized at construction; each frame's ring of K timestamps is
+ * allocated once, there.
+ *
+ * A frame is tracked from its first RecordAccess() and starts pinned
+ * (non-evictable). Only evictable frames are queued in the
+ * detail::LRUKTracker, so pinned frames cost nothing at eviction time. The
+ * tracker ranks frames with fewer than K accesses (infinite backward
+ * K-distance) first, oldest first access first, then the rest by their
+ * K-th most recent access, as for LRU_K_Cache.
+ *
+ * All operations are O(log n) and thread-safe.
+ */
+class LRUKReplacer {
+private:
+    /** @brief Per-frame bookkeeping. */
+    struct FrameMeta {
+        detail::LRUKHook<kRuntimeHistoryDepth> hook; ///< Access history and eviction rank.
+        bool tracked = false;   ///< Has been accessed since its last eviction or removal.
+        bool evictable = false; ///< Unpinned.
+
+        explicit FrameMeta(size_t k) : hook(k) {}
+    };
+
+    /**
+     * @brief Exposes a frame's hook to the tracker; a frame is its own key.
+     */
+    struct FrameTraits {
+        LRUKReplacer* replacer_;
+
+        detail::LRUKHook<kRuntimeHistoryDepth>& hook(frame_id_t frame) const { return replacer_->frames_[frame].hook; }
+        frame_id_t key(frame_id_t frame) const { return frame; }
+    };
+
+    size_t num_frames_;                       ///< Number of frames.
+    std::vector<FrameMeta> frames_;           ///< Indexed by frame id.
+    detail::LRUKTracker<frame_id_t, frame_id_t, kRuntimeHistoryDepth, FrameTraits> tracker_; ///< Evictable frames.
+    mutable std::mutex latch_;                ///< Guards all state.
+
+    void CheckFrame(frame_id_t frame) const {
+        if (frame < 0 || static_cast<size_t>(frame) >= num_frames_) {
+            THROW_RUNTIME("LRUKReplacer: invalid frame id");
+        }
+    }
+
+    void Forget(frame_id_t frame) {
+        FrameMeta& meta = frames_[frame];
+        tracker_.Reset(frame);
+        meta.tracked = false;
+        meta.evictable = false;
+    }
+
+public:
+    /**
+     * @brief Creates a replacer for a fixed number of frames.
+     *
+     * @param num_frames Number of frames, ids 0 to num_frames - 1.
+     * @param k Number of recent accesses to track per frame.
+     */
+    LRUKReplacer(size_t num_frames, size_t k)
+        : num_frames_(num_frames),
+          frames_(num_frames, FrameMeta(k)),
+          tracker_(k, FrameTraits{this}) {
+        if (k == 0 || k > std::numeric_limits<uint32_t>::max()) {
+            THROW_RUNTIME("LRUKReplacer needs K >= 1");
+        }
+        tracker_.reserve(num_frames);
+    }
+
+    LRUKReplacer(const LRUKReplacer&) = delete;
+    LRUKReplacer& operator=(const LRUKReplacer&) = delete;
+
+    /**
+     * @brief Records an access to a frame at the current timestamp.
+     *
+     * Scans and prefetches only start tracking an untracked frame: one seen
+     * only by scans is evicted before any other, one seen only by a prefetch
+     * ranks as if first accessed then. The frame's first recorded access
+     * overwrites that rank. Neither changes a tracked frame.
+     *
+     * @param frame The accessed frame.
+     * @param type Access type hint.
+     */
+    void RecordAccess(frame_id_t frame, AccessType type = AccessType::kUnknown) {
+        CheckFrame(frame);
+        std::lock_guard<std::mutex> guard(latch_);
+        FrameMeta& meta = frames_[frame];
+        if (meta.tracked) {
+            tracker_.Access(frame, type);
+        } else {
+            meta.tracked = true;
+            tracker_.Admit(frame, type);
+        }
+    }
+
+    /**
+     * @brief Pins or unpins a tracked frame.
+     *
+     * @param frame The frame.
+     * @param evictable Whether Evict() may choose it.
+     */
+    void SetEvictable(frame_id_t frame, bool evictable) {
+        CheckFrame(frame);
+        std::lock_guard<std::mutex> guard(latch_);
+        FrameMeta& meta = frames_[frame];
+        if (!meta.tracked) {
+            THROW_RUNTIME("LRUKReplacer: frame has no recorded access");
+        }
+        if (meta.evictable == evictable) return;
+        meta.evictable = evictable;
+        if (evictable) {
+            tracker_.Enqueue(frame);
+        } else {
+            tracker_.Dequeue(frame);
+        }
+    }
+
+    /**
+     * @brief Chooses and forgets the evictable frame with the largest backward K-distance.
+     *
+     * @return The evicted frame, or std::nullopt if every frame is pinned.
+     */
+    std::optional<frame_id_t> Evict() {
+        std::lock_guard<std::mutex> guard(latch_);
+        if (tracker_.empty()) return std::nullopt;
+        frame_id_t victim = tracker_.Victim();
+        tracker_.Dequeue(victim);
+        Forget(victim);
+        return victim;
+    }
+
+    /**
+     * @brief Forgets an evictable frame regardless of its K-distance.
+     *
+     * Untracked frames are ignored; removing a pinned frame is an error.
+     *
+     * @param frame The frame.
+     */
+    void Remove(frame_id_t frame) {
+        CheckFrame(frame);
+        std::lock_guard<std::mutex> guard(latch_);
+        FrameMeta& meta = frames_[frame];
+        if (!meta.tracked) return;
+        if (!meta.evictable) {
+            THROW_RUNTIME("LRUKReplacer: cannot remove a pinned frame");
+        }
+        tracker_.Dequeue(frame);
+        Forget(frame);
+    }
+
+    /**
+     * @brief Returns the number of evictable frames.
+     */
+    size_t Size() const {
+        std::lock_guard<std::mutex> guard(latch_);
+        return tracker_.size();
+    }
 };
 
 } // namespace Collections
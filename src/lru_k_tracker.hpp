@@ -0,0 +1,461 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "indexed_heap.hpp"
+
+/**
+ * @file lru_k_tracker.hpp
+ * @brief Access histories and victim ranking shared by the LRU-K caches.
+ */
+
+namespace Collections {
+
+#define THROW_RUNTIME(msg) throw std::runtime_error(msg)
+
+/** @brief Alias for the timestamp used in access history. */
+using timestamp_t = uint64_t;
+
+/**
+ * @brief Why a key or frame is accessed, as hinted by the caller.
+ *
+ * kUnknown, kLookup and kIndex are ordinary references. kScan and kPrefetch
+ * are not recorded in the access history, so a sequential scan or read-ahead
+ * cannot push the working set out by looking recently used. A new entry
+ * brought in by a scan is the next victim; one brought in by a prefetch
+ * queues behind the other entries with fewer than K accesses. Either way,
+ * its first real reference counts as its first access and queues it anew
+ * from there.
+ */
+enum class AccessType {
+    kUnknown,
+    kLookup,
+    kScan,
+    kIndex,
+    kPrefetch,
+};
+
+/** @brief Whether an access of this type is recorded in the access history. */
+inline constexpr bool IsRecordedAccess(AccessType type) {
+    return type != AccessType::kScan && type != AccessType::kPrefetch;
+}
+
+/** @brief HistoryDepth argument selecting a K chosen at runtime. */
+inline constexpr size_t kRuntimeHistoryDepth = 0;
+
+namespace detail {
+
+/**
+ * @brief Ring buffer of the last K access timestamps, stored inline.
+ *
+ * K is passed to Record() by the owner, which stores it once for all nodes.
+ *
+ * @tparam Depth Compile-time K.
+ */
+template <size_t Depth>
+class AccessHistory {
+private:
+    std::array<timestamp_t, Depth> ring_{};
+    uint32_t count_ = 0; ///< Recorded accesses, saturating at K.
+    uint32_t next_ = 0;  ///< Slot written next; the oldest slot once full.
+
+public:
+    explicit AccessHistory(size_t) {}
+
+    void Record(timestamp_t timestamp, size_t k) {
+        ring_[next_] = timestamp;
+        next_ = next_ + 1 == k ? 0 : next_ + 1;
+        if (count_ < k) count_++;
+    }
+
+    /** @brief Number of recorded accesses, at most K. */
+    size_t size() const { return count_; }
+
+    /** @brief Oldest recorded access; the K-th most recent once size() == K. */
+    timestamp_t Oldest() const { return count_ == Depth ? ring_[next_] : ring_[0]; }
+
+    /** @brief Most recent access; requires size() > 0. */
+    timestamp_t Newest() const { return ring_[next_ == 0 ? Depth - 1 : next_ - 1]; }
+
+    /** @brief Moves the most recent access to `timestamp` without adding one. */
+    void Touch(timestamp_t timestamp) { ring_[next_ == 0 ? Depth - 1 : next_ - 1] = timestamp; }
+
+    /** @brief Forgets every recorded access. */
+    void Clear() { count_ = next_ = 0; }
+};
+
+/**
+ * @brief Runtime-K fallback: the ring is one allocation of K timestamps.
+ */
+template <>
+class AccessHistory<kRuntimeHistoryDepth> {
+private:
+    std::unique_ptr<timestamp_t[]> ring_;
+    uint32_t count_ = 0;
+    uint32_t next_ = 0;
+    uint32_t depth_;
+
+public:
+    explicit AccessHistory(size_t k) : ring_(new timestamp_t[k]), depth_(static_cast<uint32_t>(k)) {}
+
+    AccessHistory(const AccessHistory& other)
+        : ring_(new timestamp_t[other.depth_]), count_(other.count_), next_(other.next_), depth_(other.depth_) {
+        std::copy(other.ring_.get(), other.ring_.get() + depth_, ring_.get());
+    }
+
+    AccessHistory& operator=(const AccessHistory& other) {
+        if (this != &other) *this = AccessHistory(other);
+        return *this;
+    }
+
+    AccessHistory(AccessHistory&&) noexcept = default;
+    AccessHistory& operator=(AccessHistory&&) noexcept = default;
+
+    void Record(timestamp_t timestamp, size_t k) {
+        ring_[next_] = timestamp;
+        next_ = next_ + 1 == k ? 0 : next_ + 1;
+        if (count_ < k) count_++;
+    }
+
+    size_t size() const { return count_; }
+
+    timestamp_t Oldest() const { return count_ == depth_ ? ring_[next_] : ring_[0]; }
+
+    timestamp_t Newest() const { return ring_[next_ == 0 ? depth_ - 1 : next_ - 1]; }
+
+    void Touch(timestamp_t timestamp) { ring_[next_ == 0 ? depth_ - 1 : next_ - 1] = timestamp; }
+
+    void Clear() { count_ = next_ = 0; }
+};
+
+/**
+ * @brief Bounded table of the access histories of evicted keys.
+ *
+ * Ghosts live in a hash map and are chained oldest to newest through
+ * intrusive links in the map's nodes, so retaining a history is one insert
+ * and resuming it is one lookup and one erase; the oldest ghost is dropped
+ * when the table is full.
+ *
+ * @tparam K Key type.
+ * @tparam History Access history type.
+ */
+template <typename K, typename History>
+class GhostTable {
+private:
+    struct Ghost {
+        History history;
+        Ghost* older = nullptr;
+        Ghost* newer = nullptr;
+        const K* key = nullptr;  ///< The map node's key.
+
+        explicit Ghost(History&& h) : history(std::move(h)) {}
+    };
+
+    std::unordered_map<K, Ghost> ghosts_;
+    Ghost* oldest_ = nullptr;
+    Ghost* newest_ = nullptr;
+    size_t capacity_;
+
+    void Unlink(Ghost* ghost) {
+        if (ghost->older != nullptr) ghost->older->newer = ghost->newer;
+        else oldest_ = ghost->newer;
+        if (ghost->newer != nullptr) ghost->newer->older = ghost->older;
+        else newest_ = ghost->older;
+    }
+
+    void PushNewest(Ghost* ghost) {
+        ghost->older = newest_;
+        ghost->newer = nullptr;
+        if (newest_ != nullptr) newest_->newer = ghost;
+        else oldest_ = ghost;
+        newest_ = ghost;
+    }
+
+public:
+    explicit GhostTable(size_t capacity) : capacity_(capacity) {}
+
+    GhostTable(const GhostTable&) = delete;
+    GhostTable& operator=(const GhostTable&) = delete;
+
+    /**
+     * @brief Retains a history as the newest ghost, replacing one for the same key.
+     */
+    void Put(K&& key, History&& history) {
+        auto it = ghosts_.find(key);
+        if (it != ghosts_.end()) {
+            Unlink(&it->second);
+            it->second.history = std::move(history);
+            PushNewest(&it->second);
+            return;
+        }
+        if (ghosts_.size() >= capacity_) {
+            Ghost* oldest = oldest_;
+            Unlink(oldest);
+            ghosts_.erase(*oldest->key);
+        }
+        it = ghosts_.emplace(std::move(key), Ghost(std::move(history))).first;
+        it->second.key = &it->first;
+        PushNewest(&it->second);
+    }
+
+    /**
+     * @brief Removes and returns the history retained for a key, if any.
+     */
+    std::optional<History> Take(const K& key) {
+        auto it = ghosts_.find(key);
+        if (it == ghosts_.end()) return std::nullopt;
+        Unlink(&it->second);
+        std::optional<History> history(std::move(it->second.history));
+        ghosts_.erase(it);
+        return history;
+    }
+
+    size_t size() const { return ghosts_.size(); }
+};
+
+/**
+ * @brief Logical clock owned by one tracker.
+ */
+class LocalClock {
+private:
+    timestamp_t now_ = 0;
+
+public:
+    timestamp_t Tick() {
+        if (now_ == std::numeric_limits<timestamp_t>::max()) {
+            THROW_RUNTIME("Timestamp overflow in LRU-K");
+        }
+        return ++now_;
+    }
+
+    timestamp_t Now() const { return now_; }
+};
+
+/**
+ * @brief Logical clock shared by several trackers, so their ranks compare.
+ *
+ * Ticks are relaxed: each tracker draws them under its own lock, which
+ * orders them within that tracker.
+ */
+class SharedClock {
+private:
+    std::atomic<timestamp_t>* time_;
+
+public:
+    explicit SharedClock(std::atomic<timestamp_t>* time) : time_(time) {}
+
+    timestamp_t Tick() { return time_->fetch_add(1, std::memory_order_relaxed) + 1; }
+
+    timestamp_t Now() const { return time_->load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Per-item LRU-K state, embedded in the item.
+ *
+ * @tparam HistoryDepth Compile-time K, or kRuntimeHistoryDepth.
+ */
+template <size_t HistoryDepth>
+struct LRUKHook {
+    AccessHistory<HistoryDepth> history;
+    uint64_t rank = 0;  ///< Eviction rank; the smallest is the victim.
+    size_t heap_index = std::numeric_limits<size_t>::max();
+
+    explicit LRUKHook(size_t k = HistoryDepth) : history(k) {}
+};
+
+/**
+ * @brief LRU-K bookkeeping shared by LRU_K_Cache, LRUKPolicy,
+ *        StripedLRUKCache and LRUKReplacer.
+ *
+ * Every item's history lives in an LRUKHook inside the item. Queued items
+ * are ranked in one IndexedHeap:
+ *  - an item with fewer than K accesses has an infinite backward K-distance
+ *    and ranks by the time it was queued, below every item with K accesses;
+ *  - an item with K accesses ranks by its K-th most recent access.
+ * The smallest rank is the victim. The owner decides which items are
+ * queued, so a replacer can keep pinned frames out of the heap while their
+ * history goes on.
+ *
+ * The tracker also implements the access-type hints, retained history
+ * (ghosts of evicted keys) and the correlated reference period, so all four
+ * LRU-K front-ends behave alike.
+ *
+ * @tparam Item Handle of an item: a node pointer or a dense id.
+ * @tparam Key Key under which evicted histories are retained.
+ * @tparam HistoryDepth Compile-time K, or kRuntimeHistoryDepth.
+ * @tparam Traits Functor whose `hook(Item)` returns the item's LRUKHook and
+ *         whose `key(Item)` returns its key.
+ * @tparam Clock LocalClock, or SharedClock to compare ranks across trackers.
+ */
+template <typename Item, typename Key, size_t HistoryDepth, typename Traits, typename Clock = LocalClock>
+class LRUKTracker {
+public:
+    using History = AccessHistory<HistoryDepth>;
+    using Hook = LRUKHook<HistoryDepth>;
+
+    /** @brief Rank bit of items with K accesses; all others rank below them. */
+    static constexpr uint64_t kHotRank = uint64_t{1} << 63;
+
+private:
+    struct RankLess {
+        Traits traits;
+
+        bool operator()(const Item& a, const Item& b) const { return traits.hook(a).rank < traits.hook(b).rank; }
+    };
+
+    struct PositionOf {
+        Traits traits;
+
+        size_t& operator()(const Item& item) const { return traits.hook(item).heap_index; }
+    };
+
+    Traits traits_;
+    size_t k_;
+    Clock clock_;
+    IndexedHeap<Item, RankLess, PositionOf> heap_;     ///< Queued items.
+    std::optional<GhostTable<Key, History>> ghosts_;   ///< Histories of evicted keys.
+    timestamp_t retained_period_ = 0;                  ///< Ghosts idle longer than this are ignored; 0 = no limit.
+    timestamp_t correlated_period_ = 0;                ///< Burst window of correlated accesses; 0 = off.
+
+    /**
+     * @brief Records one access. An access within the correlated reference
+     *        period of the previous one only moves that timestamp forward.
+     */
+    void Record(Hook& hook) {
+        timestamp_t now = clock_.Tick();
+        if (correlated_period_ > 0 && hook.history.size() > 0 &&
+            now - hook.history.Newest() <= correlated_period_) {
+            hook.history.Touch(now);
+        } else {
+            hook.history.Record(now, k_);
+        }
+    }
+
+    /**
+     * @brief Records an item's first real access, resuming its retained
+     *        history if the key was evicted recently, and ranks it as queued now.
+     */
+    void Start(Item item, Hook& hook) {
+        if (ghosts_.has_value()) {
+            if (auto ghost = ghosts_->Take(traits_.key(item))) {
+                if (retained_period_ == 0 || clock_.Now() - ghost->Newest() <= retained_period_) {
+                    hook.history = std::move(*ghost);
+                }
+            }
+        }
+        Record(hook);
+        hook.rank = hook.history.size() < k_ ? hook.history.Newest() : kHotRank | hook.history.Oldest();
+    }
+
+public:
+    explicit LRUKTracker(size_t k, Traits traits = Traits(), Clock clock = Clock())
+        : traits_(traits), k_(k), clock_(clock), heap_(RankLess{traits}, PositionOf{traits}) {}
+
+    LRUKTracker(const LRUKTracker&) = delete;
+    LRUKTracker& operator=(const LRUKTracker&) = delete;
+
+    /**
+     * @brief Starts tracking an item with no history.
+     *
+     * An item brought in by a scan ranks before every other one and one
+     * brought in by a prefetch ranks as if queued now; neither records an
+     * access, so its first real one (see Access()) starts its history.
+     */
+    void Admit(Item item, AccessType type) {
+        Hook& hook = traits_.hook(item);
+        if (IsRecordedAccess(type)) {
+            Start(item, hook);
+        } else {
+            hook.rank = type == AccessType::kPrefetch ? clock_.Tick() : 0;
+        }
+    }
+
+    /**
+     * @brief Records an access to an admitted item and requeues it.
+     *
+     * A sub-K item keeps its rank until its K-th access. Scans and
+     * prefetches are ignored.
+     */
+    void Access(Item item, AccessType type) {
+        if (!IsRecordedAccess(type)) return;
+        Hook& hook = traits_.hook(item);
+        uint64_t rank = hook.rank;
+        if (hook.history.size() == 0) {
+            Start(item, hook);
+        } else {
+            Record(hook);
+            if (hook.history.size() == k_) hook.rank = kHotRank | hook.history.Oldest();
+        }
+        if (hook.rank != rank && heap_.contains(item)) heap_.update(item);
+    }
+
+    /** @brief Makes an item a candidate victim. */
+    void Enqueue(Item item) { heap_.push(item); }
+
+    /** @brief Withdraws a queued item; its history is kept. */
+    void Dequeue(Item item) { heap_.erase(item); }
+
+    bool Queued(Item item) const { return heap_.contains(item); }
+
+    /** @brief Returns the queued item with the smallest rank; requires !empty(). */
+    Item Victim() const { return heap_.top(); }
+
+    /** @brief Eviction rank of an item; comparable across trackers sharing a clock. */
+    uint64_t Rank(Item item) const { return traits_.hook(item).rank; }
+
+    /**
+     * @brief Hands the history of an evicted, dequeued item to the ghost
+     *        table under `key`, if histories are retained.
+     */
+    template <typename KeyArg>
+    void Retain(Item item, KeyArg&& key) {
+        Hook& hook = traits_.hook(item);
+        if (ghosts_.has_value() && hook.history.size() > 0) {
+            ghosts_->Put(Key(std::forward<KeyArg>(key)), std::move(hook.history));
+        }
+    }
+
+    /** @brief Forgets an item's history so it can be admitted again. */
+    void Reset(Item item) {
+        Hook& hook = traits_.hook(item);
+        hook.history.Clear();
+        hook.rank = 0;
+    }
+
+    /** @brief See LRU_K_Cache::set_retained_history(). */
+    void set_retained_history(size_t capacity, timestamp_t period) {
+        if (capacity == 0) {
+            ghosts_.reset();
+        } else {
+            ghosts_.emplace(capacity);
+        }
+        retained_period_ = period;
+    }
+
+    /** @brief See LRU_K_Cache::set_correlated_reference_period(). */
+    void set_correlated_reference_period(timestamp_t period) { correlated_period_ = period; }
+
+    size_t ghost_size() const { return ghosts_.has_value() ? ghosts_->size() : 0; }
+
+    void reserve(size_t count) { heap_.reserve(count); }
+
+    size_t k() const { return k_; }
+
+    bool empty() const { return heap_.empty(); }
+
+    size_t size() const { return heap_.size(); }
+};
+
+} // namespace detail
+
+} // namespace Collections
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file lz_codec.hpp
+ * @brief Small LZ77 block codec in the style of LZ4.
+ */
+
+namespace Collections {
+
+/**
+ * @brief Fast byte-oriented LZ77 compressor with a greedy hash matcher.
+ *
+ * A block is a series of sequences. Each sequence is a token byte whose high
+ * nibble is the literal count and low nibble the match length minus 4 (15 in
+ * either nibble means more length bytes follow, each adding up to 255), the
+ * literals, a 16-bit little-endian match offset and any extra match length
+ * bytes. The last sequence has literals only. The uncompressed size is not
+ * stored; callers keep it next to the block.
+ *
+ * Decompress() validates every length and offset, so corrupt input yields
+ * std::nullopt rather than out-of-bounds access.
+ *
+ * An instance keeps its 64 KiB match table between Compress() calls. Table
+ * entries are positions offset by a per-call base, so entries left by an
+ * earlier block read as empty and the table is neither reallocated nor
+ * cleared per call. An instance must not compress from two threads at once;
+ * Decompress() is static.
+ */
+class LZCodec {
+private:
+    static constexpr size_t kMinMatch = 4;
+    static constexpr size_t kMaxOffset = 65535;
+    static constexpr int kHashBits = 14;
+    static constexpr unsigned kSkipTrigger = 6;  ///< Misses before the scan step grows.
+
+    std::vector<uint32_t> table_;  ///< Match candidates, as base_ + position.
+    uint32_t base_ = 1;            ///< Entries below this belong to earlier blocks; 0 is never valid.
+
+    static uint32_t Load32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t HashOf(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - kHashBits); }
+
+    static void PutLength(std::vector<uint8_t>& out, size_t extra) {
+        while (extra >= 255) {
+            out.push_back(255);
+            extra -= 255;
+        }
+        out.push_back(static_cast<uint8_t>(extra));
+    }
+
+    static void EmitSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literal_count,
+                             size_t offset, size_t match_length) {
+        size_t match_code = match_length - kMinMatch;
+        uint8_t token = static_cast<uint8_t>((literal_count >= 15 ? 15 : literal_count) << 4 |
+                                             (match_code >= 15 ? 15 : match_code));
+        out.push_back(token);
+        if (literal_count >= 15) PutLength(out, literal_count - 15);
+        out.insert(out.end(), literals, literals + literal_count);
+        out.push_back(static_cast<uint8_t>(offset));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (match_code >= 15) PutLength(out, match_code - 15);
+    }
+
+    static void EmitLastLiterals(std::vector<uint8_t>& out, const uint8_t* literals, size_t literal_count) {
+        out.push_back(static_cast<uint8_t>((literal_count >= 15 ? 15 : literal_count) << 4));
+        if (literal_count >= 15) PutLength(out, literal_count - 15);
+        out.insert(out.end(), literals, literals + literal_count);
+    }
+
+    static bool GetLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+        uint8_t byte;
+        do {
+            if (ip == end) return false;
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+public:
+    /**
+     * @brief Compresses `size` bytes into a new block.
+     *
+     * @throws std::length_error if `size` is 4 GiB or more.
+     */
+    std::vector<uint8_t> Compress(const uint8_t* src, size_t size) {
+        if (size >= UINT32_MAX) throw std::length_error("LZCodec block must be smaller than 4 GiB");
+        if (table_.empty() || size >= UINT32_MAX - base_) {
+            table_.assign(size_t{1} << kHashBits, 0);
+            base_ = 1;
+        }
+        const uint32_t base = base_;
+        base_ += static_cast<uint32_t>(size);
+
+        std::vector<uint8_t> out;
+        out.reserve(size + size / 255 + 16);
+
+        size_t anchor = 0;
+        size_t pos = 0;
+        unsigned misses = 0;
+        while (pos + kMinMatch <= size) {
+            uint32_t sequence = Load32(src + pos);
+            uint32_t& slot = table_[HashOf(sequence)];
+            uint32_t entry = slot;
+            slot = base + static_cast<uint32_t>(pos);
+            size_t candidate = entry - base;
+
+            if (entry >= base && pos - candidate <= kMaxOffset && Load32(src + candidate) == sequence) {
+                size_t length = kMinMatch;
+                while (pos + length < size && src[candidate + length] == src[pos + length]) ++length;
+                EmitSequence(out, src + anchor, pos - anchor, pos - candidate, length);
+                pos += length;
+                anchor = pos;
+                misses = 0;
+            } else {
+                pos += 1 + (misses++ >> kSkipTrigger);
+            }
+        }
+        EmitLastLiterals(out, src + anchor, size - anchor);
+        return out;
+    }
+
+    std::vector<uint8_t> Compress(const std::vector<uint8_t>& src) { return Compress(src.data(), src.size()); }
+
+    /**
+     * @brief Decompresses a block that expands to exactly `original_size` bytes.
+     *
+     * @return The bytes, or std::nullopt if the block is malformed.
+     */
+    static std::optional<std::vector<uint8_t>> Decompress(const uint8_t* src, size_t size,
+                                                          size_t original_size) {
+        std::vector<uint8_t> out(original_size);
+        uint8_t* op = out.data();
+        uint8_t* const out_end = op + original_size;
+        const uint8_t* ip = src;
+        const uint8_t* const end = src + size;
+
+        while (ip < end) {
+            uint8_t token = *ip++;
+            size_t literal_count = token >> 4;
+            if (literal_count == 15 && !GetLength(ip, end, literal_count)) return std::nullopt;
+            if (literal_count > static_cast<size_t>(end - ip) || literal_count > static_cast<size_t>(out_end - op))
+                return std::nullopt;
+            if (literal_count != 0) std::memcpy(op, ip, literal_count);  // op is null for an empty block
+            op += literal_count;
+            ip += literal_count;
+            if (ip == end) break;  // last sequence
+
+            if (end - ip < 2) return std::nullopt;
+            size_t offset = ip[0] | (size_t{ip[1]} << 8);
+            ip += 2;
+            size_t match_length = token & 15;
+            if (match_length == 15 && !GetLength(ip, end, match_length)) return std::nullopt;
+            match_length += kMinMatch;
+            if (offset == 0 || offset > static_cast<size_t>(op - out.data()) ||
+                match_length > static_cast<size_t>(out_end - op))
+                return std::nullopt;
+
+            const uint8_t* match = op - offset;
+            if (offset >= match_length) {
+                std::memcpy(op, match, match_length);
+                op += match_length;
+            } else {
+                for (size_t i = 0; i < match_length; ++i) *op++ = match[i];  // overlapping run
+            }
+        }
+        if (op != out_end) return std::nullopt;
+        return out;
+    }
+
+    static std::optional<std::vector<uint8_t>> Decompress(const std::vector<uint8_t>& src, size_t original_size) {
+        return Decompress(src.data(), src.size(), original_size);
+    }
+};
+
+} // namespace Collections
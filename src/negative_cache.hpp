@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "bloom_filter.hpp"
+#include "cache.hpp"
+
+/**
+ * @file negative_cache.hpp
+ * @brief LRU cache that also remembers keys known to be absent from the backend.
+ */
+
+namespace Collections {
+
+/**
+ * @brief Outcome of a NegativeCache lookup.
+ */
+enum class LookupState {
+    kMiss,    ///< Unknown: the backend must be consulted.
+    kHit,     ///< Present; the value is returned.
+    kAbsent,  ///< Known not to exist in the backend.
+};
+
+template <typename V>
+struct LookupResult {
+    LookupState state;
+    std::optional<V> value;  ///< Set only for kHit.
+};
+
+/**
+ * @brief Configuration of a NegativeCache.
+ */
+struct NegativeCacheOptions {
+    int capacity = 1024;                                  ///< Total entries, positive plus negative.
+    double negative_share = 0.25;                         ///< Share of capacity for negative entries.
+    std::chrono::nanoseconds negative_ttl = std::chrono::seconds(30);  ///< Lifetime of a negative entry.
+};
+
+/**
+ * @brief A bounded cache with first-class negative entries and an optional
+ *        existence filter.
+ *
+ * Values live in one Cache. Keys reported absent by the backend live in a
+ * second Cache, sized by NegativeCacheOptions::negative_share, that maps
+ * each key to its expiry time; an expired negative entry reads as a miss.
+ * Storing a value for a key drops its negative entry and vice versa.
+ *
+ * The optional filter is a Bloom filter of keys that MAY EXIST, built by the
+ * owner from the backend's key set and extended by every put(), add_key()
+ * and erase(). A key the filter rejects is definitely absent, so the lookup
+ * is answered kAbsent without touching either hash index or the backend.
+ * A filter of known-absent keys would be unsafe: its false positives would
+ * report existing keys as absent, and a key could not leave it once created.
+ *
+ * Unlike a negative entry, a filter rejection never expires. A key created
+ * in the backend behind the cache's back stays absent until the owner
+ * reports it with add_key() or erase().
+ *
+ * @tparam K Key type.
+ * @tparam V Value type.
+ * @tparam Hash Hash functor for K.
+ * @tparam Policy Replacement policy of both caches (see cache.hpp).
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename Policy = LRUPolicy>
+class NegativeCache {
+public:
+    using clock_type = std::function<std::chrono::steady_clock::time_point()>;
+
+private:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    Cache<K, V, Policy, UnorderedIndex, NoStats, NullLock, Hash> positive_;
+    Cache<K, time_point, Policy, UnorderedIndex, NoStats, NullLock, Hash> negative_;
+    std::chrono::nanoseconds negative_ttl_;
+    clock_type now_;
+    std::optional<BloomFilter<K, Hash>> key_filter_;
+
+    static int NegativeCapacity(const NegativeCacheOptions& options) {
+        if (options.capacity < 2) throw std::invalid_argument("NegativeCache capacity must be at least 2");
+        if (!(options.negative_share > 0.0 && options.negative_share < 1.0))
+            throw std::invalid_argument("NegativeCache negative share must be in (0, 1)");
+        int negative = static_cast<int>(options.capacity * options.negative_share);
+        return std::clamp(negative, 1, options.capacity - 1);
+    }
+
+public:
+    /**
+     * @brief Creates the cache.
+     *
+     * @param options Capacity split and negative TTL.
+     * @param clock Time source for negative expiry; steady_clock by default.
+     */
+    explicit NegativeCache(NegativeCacheOptions options = {}, clock_type clock = nullptr)
+        : positive_(options.capacity - NegativeCapacity(options)),
+          negative_(NegativeCapacity(options)),
+          negative_ttl_(options.negative_ttl),
+          now_(clock ? std::move(clock) : clock_type([] { return std::chrono::steady_clock::now(); })) {}
+
+    /**
+     * @brief Installs a filter of every key that may exist in the backend.
+     *
+     * The caller must have inserted every existing key; put() keeps it up to
+     * date afterwards. Erased keys stay in the filter, which only costs
+     * precision.
+     */
+    void set_key_filter(BloomFilter<K, Hash> filter) { key_filter_.emplace(std::move(filter)); }
+
+    void clear_key_filter() { key_filter_.reset(); }
+
+    const std::optional<BloomFilter<K, Hash>>& key_filter() const { return key_filter_; }
+
+    /**
+     * @brief Records that a key may now exist in the backend.
+     *
+     * Call it when another writer creates a key; until then the filter keeps
+     * rejecting it. Drops the key's negative entry, if any.
+     */
+    void add_key(const K& key) {
+        negative_.erase(key);
+        if (key_filter_.has_value()) key_filter_->insert(key);
+    }
+
+    /**
+     * @brief Looks a key up in the filter, the value cache and the negative cache.
+     */
+    LookupResult<V> get(const K& key) {
+        if (key_filter_.has_value() && !key_filter_->possibly_contains(key))
+            return {LookupState::kAbsent, std::nullopt};
+
+        std::optional<V> value = positive_.get(key);
+        if (value.has_value()) return {LookupState::kHit, std::move(value)};
+
+        std::optional<time_point> expiry = negative_.get(key);
+        if (!expiry.has_value()) return {LookupState::kMiss, std::nullopt};
+        if (now_() >= *expiry) {
+            negative_.erase(key);
+            return {LookupState::kMiss, std::nullopt};
+        }
+        return {LookupState::kAbsent, std::nullopt};
+    }
+
+    /**
+     * @brief Caches a value, replacing any negative entry for the key.
+     */
+    void put(K key, V value) {
+        negative_.erase(key);
+        if (key_filter_.has_value()) key_filter_->insert(key);
+        positive_.put(std::move(key), std::move(value));
+    }
+
+    /**
+     * @brief Records that the backend has no value for the key.
+     */
+    void put_absent(K key) {
+        positive_.erase(key);
+        negative_.put(std::move(key), now_() + negative_ttl_);
+    }
+
+    /**
+     * @brief Forgets everything cached about a key.
+     *
+     * The key is also added to the filter, so the next get() reports a miss
+     * and the backend is asked again.
+     *
+     * @return True if a positive or negative entry was removed.
+     */
+    bool erase(const K& key) {
+        if (key_filter_.has_value()) key_filter_->insert(key);
+        bool removed = positive_.erase(key);
+        return negative_.erase(key) || removed;
+    }
+
+    size_t size() const { return positive_.size() + negative_.size(); }
+
+    size_t positive_size() const { return positive_.size(); }
+
+    size_t negative_size() const { return negative_.size(); }
+};
+
+} // namespace Collections
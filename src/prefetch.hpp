@@ -0,0 +1,23 @@
+#pragma once
+
+/**
+ * @file prefetch.hpp
+ * @brief Portable software prefetch hints.
+ */
+
+namespace Collections {
+
+namespace detail {
+
+/** @brief Hints the cache to load the line holding `address` for reading. */
+inline void PrefetchRead(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 1);
+#else
+    (void)address;
+#endif
+}
+
+} // namespace detail
+
+} // namespace Collections
@@ -0,0 +1,356 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "prefetch.hpp"
+
+/**
+ * @file robin_hood_set.hpp
+ * @brief Linear-probing Robin Hood hash set for integer keys.
+ */
+
+namespace Collections {
+
+/**
+ * @brief A dense hash set of integers with Robin Hood linear probing.
+ *
+ * Keys are stored in a flat array. A parallel byte array holds each slot's
+ * probe distance plus one, with 0 meaning empty. An insertion takes the slot
+ * of any resident that sits closer to its home slot, so probe lengths stay
+ * short and even at high load. A lookup stops as soon as it meets a
+ * resident closer to home than itself.
+ *
+ * Probe distances are bounded by kMaxProbe. The arrays carry kMaxProbe
+ * spare slots past the last home slot, so probing never wraps. An insertion
+ * that would probe further grows the table instead; so does one that would
+ * pass max_load_factor() (0.9 by default, at most kMaxLoadFactor). Erase shifts the
+ * following cluster back by one slot, so there are no tombstones.
+ *
+ * Homes come from Fibonacci hashing of the key, which spreads sequential
+ * and strided keys evenly.
+ *
+ * @tparam K Integral key type.
+ */
+template <std::integral K>
+class RobinHoodSet {
+public:
+    using key_type = K;
+    using value_type = K;
+    using size_type = size_t;
+
+    /** @brief Longest probe sequence any key may need. */
+    static constexpr size_t kMaxProbe = 128;
+
+    /**
+     * @brief Highest accepted max_load_factor().
+     *
+     * Random 64-bit keys reach it without a kMaxProbe growth at up to 2^24
+     * home slots; at 0.97 the probe bound already forces growth from about
+     * 2^22 slots, before the load factor does.
+     */
+    static constexpr float kMaxLoadFactor = 0.95f;
+
+    /**
+     * @brief Forward iterator over the stored keys.
+     */
+    class const_iterator {
+    private:
+        friend class RobinHoodSet;
+
+        const K* key_ = nullptr;
+        const uint8_t* distance_ = nullptr;
+        const uint8_t* end_ = nullptr;
+
+        const_iterator(const K* key, const uint8_t* distance, const uint8_t* end)
+            : key_(key), distance_(distance), end_(end) {
+            SkipEmpty();
+        }
+
+        void SkipEmpty() {
+            while (distance_ != end_ && *distance_ == 0) {
+                ++distance_;
+                ++key_;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = K;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const K*;
+        using reference = const K&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return *key_; }
+        pointer operator->() const { return key_; }
+
+        const_iterator& operator++() {
+            ++distance_;
+            ++key_;
+            SkipEmpty();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        friend bool operator==(const const_iterator& a, const const_iterator& b) {
+            return a.distance_ == b.distance_;
+        }
+    };
+
+    using iterator = const_iterator;
+
+private:
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+    static constexpr size_t kMinCapacity = 16;
+
+    std::unique_ptr<K[]> keys_;
+    std::unique_ptr<uint8_t[]> distances_;  ///< Probe distance + 1 per slot; 0 is empty.
+    size_t capacity_ = 0;                   ///< Home slots: zero or a power of two.
+    int shift_ = 64;                        ///< 64 - log2(capacity_).
+    size_t size_ = 0;
+    float max_load_factor_ = 0.9f;
+
+    size_t Slots() const { return capacity_ == 0 ? 0 : capacity_ + kMaxProbe; }
+
+    size_t Home(K key) const {
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+    size_t MaxSize(size_t capacity) const { return static_cast<size_t>(capacity * max_load_factor_); }
+
+    size_t Find(K key) const {
+        if (capacity_ == 0) return kNotFound;
+        size_t index = Home(key);
+        for (uint8_t distance = 1; distance <= distances_[index]; ++distance, ++index) {
+            if (keys_[index] == key) return index;
+        }
+        return kNotFound;
+    }
+
+    /**
+     * @brief Places an absent key, displacing residents closer to their home.
+     *
+     * @param key In: the key to place. Out, on failure: the key left without
+     *        a slot, which may be a displaced resident.
+     * @return False if some key would exceed kMaxProbe.
+     */
+    bool Place(K& key) {
+        size_t index = Home(key);
+        uint8_t distance = 1;
+        while (true) {
+            if (distances_[index] == 0) {
+                keys_[index] = key;
+                distances_[index] = distance;
+                return true;
+            }
+            if (distances_[index] < distance) {
+                std::swap(key, keys_[index]);
+                std::swap(distance, distances_[index]);
+            }
+            ++index;
+            if (++distance > kMaxProbe) return false;
+        }
+    }
+
+    /** @brief Rehashes every key into `capacity` home slots, doubling until all fit. */
+    void Rehash(size_t capacity) {
+        while (true) {
+            RobinHoodSet next;
+            next.Allocate(capacity);
+            next.max_load_factor_ = max_load_factor_;
+            bool placed = true;
+            for (size_t i = 0; placed && i < Slots(); ++i) {
+                if (distances_[i] == 0) continue;
+                K key = keys_[i];
+                placed = next.Place(key);
+            }
+            if (placed) {
+                next.size_ = size_;
+                *this = std::move(next);
+                return;
+            }
+            capacity *= 2;
+        }
+    }
+
+    void Allocate(size_t capacity) {
+        capacity_ = capacity;
+        shift_ = 64 - std::countr_zero(capacity);
+        keys_ = std::make_unique<K[]>(capacity + kMaxProbe);
+        distances_ = std::make_unique<uint8_t[]>(capacity + kMaxProbe);  // zeroed: all empty
+    }
+
+    size_t CapacityFor(size_t count) const {
+        size_t capacity = kMinCapacity;
+        while (MaxSize(capacity) < count) capacity *= 2;
+        return capacity;
+    }
+
+public:
+    RobinHoodSet() = default;
+
+    /**
+     * @brief Creates an empty set with room for `count` keys.
+     */
+    explicit RobinHoodSet(size_t count) { reserve(count); }
+
+    RobinHoodSet(std::initializer_list<K> keys) {
+        reserve(keys.size());
+        for (K key : keys) insert(key);
+    }
+
+    RobinHoodSet(const RobinHoodSet& other)
+        : capacity_(other.capacity_),
+          shift_(other.shift_),
+          size_(other.size_),
+          max_load_factor_(other.max_load_factor_) {
+        if (capacity_ == 0) return;
+        keys_ = std::make_unique<K[]>(Slots());
+        distances_ = std::make_unique<uint8_t[]>(Slots());
+        std::copy_n(other.keys_.get(), Slots(), keys_.get());
+        std::copy_n(other.distances_.get(), Slots(), distances_.get());
+    }
+
+    RobinHoodSet(RobinHoodSet&& other) noexcept
+        : keys_(std::move(other.keys_)),
+          distances_(std::move(other.distances_)),
+          capacity_(std::exchange(other.capacity_, 0)),
+          shift_(std::exchange(other.shift_, 64)),
+          size_(std::exchange(other.size_, 0)),
+          max_load_factor_(other.max_load_factor_) {}
+
+    RobinHoodSet& operator=(RobinHoodSet other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(RobinHoodSet& other) noexcept {
+        std::swap(keys_, other.keys_);
+        std::swap(distances_, other.distances_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(shift_, other.shift_);
+        std::swap(size_, other.size_);
+        std::swap(max_load_factor_, other.max_load_factor_);
+    }
+
+    const_iterator begin() const { return {keys_.get(), distances_.get(), distances_.get() + Slots()}; }
+
+    const_iterator end() const {
+        const uint8_t* end = distances_.get() + Slots();
+        return {keys_.get() + Slots(), end, end};
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /** @brief Number of home slots. */
+    size_t bucket_count() const { return capacity_; }
+
+    float load_factor() const { return capacity_ == 0 ? 0.0f : static_cast<float>(size_) / capacity_; }
+
+    float max_load_factor() const { return max_load_factor_; }
+
+    /**
+     * @brief Sets the load factor that triggers growth.
+     *
+     * @param load In (0, kMaxLoadFactor]; higher values save memory at the
+     *        cost of longer probes.
+     */
+    void max_load_factor(float load) {
+        if (!(load > 0.0f && load <= kMaxLoadFactor))
+            throw std::invalid_argument("RobinHoodSet max load factor must be in (0, 0.95]");
+        max_load_factor_ = load;
+        if (size_ > MaxSize(capacity_)) Rehash(CapacityFor(size_));
+    }
+
+    /**
+     * @brief Makes room for `count` keys without further growth from load.
+     */
+    void reserve(size_t count) {
+        if (count > MaxSize(capacity_)) Rehash(CapacityFor(count));
+    }
+
+    void clear() {
+        if (capacity_ != 0) std::fill_n(distances_.get(), Slots(), uint8_t{0});
+        size_ = 0;
+    }
+
+    bool contains(K key) const { return Find(key) != kNotFound; }
+
+    size_t count(K key) const { return contains(key) ? 1 : 0; }
+
+    /**
+     * @brief Looks up a batch of keys, prefetching a few keys ahead.
+     *
+     * Software-pipelines independent lookups so their cache misses overlap,
+     * which pays off when the set is larger than the cache.
+     *
+     * @param keys Keys to look up.
+     * @param found Receives one result per key; must be as long as `keys`.
+     * @return The number of keys found.
+     */
+    size_t contains_many(std::span<const K> keys, std::span<bool> found) const {
+        if (found.size() < keys.size())
+            throw std::invalid_argument("RobinHoodSet::contains_many: output too short");
+        constexpr size_t kLookahead = 8;
+        size_t hits = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (capacity_ != 0 && i + kLookahead < keys.size()) {
+                size_t home = Home(keys[i + kLookahead]);
+                detail::PrefetchRead(distances_.get() + home);
+                detail::PrefetchRead(keys_.get() + home);
+            }
+            found[i] = contains(keys[i]);
+            hits += found[i];
+        }
+        return hits;
+    }
+
+    /**
+     * @brief Adds a key.
+     * @return True if it was not already present.
+     */
+    bool insert(K key) {
+        if (contains(key)) return false;
+        if (size_ + 1 > MaxSize(capacity_)) Rehash(CapacityFor(size_ + 1));
+        while (!Place(key)) Rehash(capacity_ * 2);  // `key` is now whichever key was left over
+        ++size_;
+        return true;
+    }
+
+    /**
+     * @brief Removes a key, shifting the rest of its cluster one slot back.
+     * @return True if it was present.
+     */
+    bool erase(K key) {
+        size_t index = Find(key);
+        if (index == kNotFound) return false;
+        size_t next = index + 1;
+        while (next < Slots() && distances_[next] > 1) {
+            keys_[next - 1] = keys_[next];
+            distances_[next - 1] = static_cast<uint8_t>(distances_[next] - 1);
+            ++next;
+        }
+        distances_[next - 1] = 0;
+        --size_;
+        return true;
+    }
+};
+
+} // namespace Collections
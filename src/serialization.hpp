@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @file serialization.hpp
+ * @brief Byte-level encoding helpers shared by the persistent cache features.
+ *
+ * Encodings use the host byte order: files are meant to be read back by the
+ * same build on the same machine (warm restarts, local overflow tiers), not
+ * exchanged between architectures.
+ */
+
+namespace Collections {
+
+/**
+ * @brief 64-bit FNV-1a hash, used as a streaming checksum.
+ */
+class Fnv1a64 {
+private:
+    uint64_t state_ = 0xcbf29ce484222325ULL;
+
+public:
+    /**
+     * @brief Feeds bytes into the checksum.
+     */
+    void update(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            state_ ^= bytes[i];
+            state_ *= 0x100000001b3ULL;
+        }
+    }
+
+    /**
+     * @brief Returns the checksum of all bytes fed so far.
+     */
+    uint64_t digest() const { return state_; }
+};
+
+/**
+ * @brief Byte sink writing to a std::ostream while checksumming the bytes.
+ */
+class ChecksumWriter {
+private:
+    std::ostream& out_;
+    Fnv1a64 checksum_;
+
+public:
+    explicit ChecksumWriter(std::ostream& out) : out_(out) {}
+
+    void write(const void* data, size_t size) {
+        checksum_.update(data, size);
+        out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+
+    bool good() const { return out_.good(); }
+
+    uint64_t digest() const { return checksum_.digest(); }
+};
+
+/**
+ * @brief Byte source reading from a std::istream.
+ */
+class StreamReader {
+private:
+    std::istream& in_;
+
+public:
+    explicit StreamReader(std::istream& in) : in_(in) {}
+
+    bool read(void* data, size_t size) {
+        in_.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        return static_cast<size_t>(in_.gcount()) == size;
+    }
+};
+
+/**
+ * @brief Byte sink appending to an in-memory buffer.
+ */
+class BufferWriter {
+private:
+    std::string& buffer_;
+
+public:
+    explicit BufferWriter(std::string& buffer) : buffer_(buffer) {}
+
+    void write(const void* data, size_t size) {
+        buffer_.append(static_cast<const char*>(data), size);
+    }
+};
+
+/**
+ * @brief Byte source reading from an in-memory buffer.
+ */
+class BufferReader {
+private:
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+
+public:
+    BufferReader(const void* data, size_t size) : data_(static_cast<const char*>(data)), size_(size) {}
+
+    bool read(void* data, size_t size) {
+        if (size_ - offset_ < size) return false;
+        std::memcpy(data, data_ + offset_, size);
+        offset_ += size;
+        return true;
+    }
+};
+
+/**
+ * @brief Encodes and decodes values of type T to and from a byte stream.
+ *
+ * Specializations exist for trivially copyable types, std::basic_string and
+ * std::vector of trivially copyable elements. Other types can be made
+ * persistent by specializing Codec with the same two static functions:
+ *
+ * @code
+ * template <typename Sink>   static void Write(Sink& out, const T& value);
+ * template <typename Source> static bool Read(Source& in, T& value);
+ * @endcode
+ *
+ * @tparam T The type to encode.
+ */
+template <typename T>
+struct Codec;
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+struct Codec<T> {
+    template <typename Sink>
+    static void Write(Sink& out, const T& value) {
+        out.write(&value, sizeof(T));
+    }
+
+    template <typename Source>
+    static bool Read(Source& in, T& value) {
+        return in.read(&value, sizeof(T));
+    }
+};
+
+template <typename CharT, typename Traits, typename Alloc>
+    requires std::is_trivially_copyable_v<CharT>
+struct Codec<std::basic_string<CharT, Traits, Alloc>> {
+    using string_type = std::basic_string<CharT, Traits, Alloc>;
+
+    template <typename Sink>
+    static void Write(Sink& out, const string_type& value) {
+        uint64_t length = value.size();
+        out.write(&length, sizeof(length));
+        out.write(value.data(), length * sizeof(CharT));
+    }
+
+    template <typename Source>
+    static bool Read(Source& in, string_type& value) {
+        uint64_t length = 0;
+        if (!in.read(&length, sizeof(length))) return false;
+        value.resize(length);
+        return in.read(value.data(), length * sizeof(CharT));
+    }
+};
+
+template <typename T, typename Alloc>
+    requires std::is_trivially_copyable_v<T>
+struct Codec<std::vector<T, Alloc>> {
+    template <typename Sink>
+    static void Write(Sink& out, const std::vector<T, Alloc>& value) {
+        uint64_t length = value.size();
+        out.write(&length, sizeof(length));
+        out.write(value.data(), length * sizeof(T));
+    }
+
+    template <typename Source>
+    static bool Read(Source& in, std::vector<T, Alloc>& value) {
+        uint64_t length = 0;
+        if (!in.read(&length, sizeof(length))) return false;
+        value.resize(length);
+        return in.read(value.data(), length * sizeof(T));
+    }
+};
+
+/**
+ * @brief Satisfied by types that have a usable Codec specialization.
+ */
+template <typename T>
+concept Serializable = requires(BufferWriter& out, BufferReader& in, const T& value, T& target) {
+    Codec<T>::Write(out, value);
+    { Codec<T>::Read(in, target) } -> std::convertible_to<bool>;
+};
+
+} // namespace Collections
@@ -0,0 +1,443 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "slot_index.hpp"
+
+/**
+ * @file shared_lru_cache.hpp
+ * @brief LRU cache living in a POSIX shared-memory segment, shared by the
+ *        processes of one host.
+ */
+
+namespace Collections {
+
+/**
+ * @brief An LRU cache whose index, entries and recency links live in shared memory.
+ *
+ * Every process that opens the same segment name sees the same cache. The
+ * segment holds no pointers: recency links and the open-addressing index
+ * (a detail::SlotIndex) store 32-bit slot indices, so each process may map
+ * it at any address.
+ * Keys and values are copied in and out and must be trivially copyable; the
+ * hash must give the same result in every process (std::hash of integers
+ * does).
+ *
+ * Operations serialize on a process-shared robust mutex stored in the
+ * segment. If a process dies while holding it, the next locker receives
+ * EOWNERDEAD, flags the segment and rebuilds the index, recency list and
+ * free list from the per-slot state, so a crash never leaves the lock held
+ * or the structure corrupt. The flag is cleared only once a rebuild
+ * completes: if it throws or its process dies, the next locker rebuilds
+ * again. Rebuilding only relies on
+ * the invariants kept by every mutation:
+ *  - a slot's key, value and access stamp are written before its state is
+ *    published as used, and its state is cleared before it is unlinked;
+ *  - an update writes the new value into a spare slot and frees the old one
+ *    afterwards, so a torn update leaves two copies and the newer stamp wins.
+ * Recency order is restored from the access stamps.
+ *
+ * @tparam K Key type (trivially copyable).
+ * @tparam V Value type (trivially copyable).
+ * @tparam Hash Hash functor, deterministic across processes.
+ * @tparam KeyEqual Equality functor.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+    requires std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V> &&
+             std::predicate<const KeyEqual&, const K&, const K&>
+class SharedLRUCache {
+private:
+    using position_t = detail::SlotIndex::position_t;
+
+    static constexpr uint64_t kMagic = 0x5348524c52553032ULL;  // "SHRLRU02"
+    static constexpr uint32_t kEmpty = detail::SlotIndex::kEmpty;
+    static constexpr size_t kNotFound = detail::SlotIndex::kNotFound;
+
+    enum SlotState : uint32_t { kFree = 0, kUsed = 1 };
+
+    /** @brief Segment header, followed by the slot array and the index table. */
+    struct Header {
+        uint64_t magic;
+        uint32_t capacity;       ///< Maximum resident entries.
+        uint32_t slot_count;     ///< capacity + 1 data slots (one spare for updates).
+        uint32_t table_size;     ///< Power of two.
+        uint32_t key_size;
+        uint32_t value_size;
+        uint32_t size;           ///< Resident entries.
+        uint32_t free_head;      ///< Free slots, linked through next.
+        uint64_t clock;          ///< Source of access stamps.
+        uint64_t recoveries;     ///< Rebuilds after a holder died.
+        uint32_t needs_recovery; ///< Set when a rebuild failed; the next locker retries.
+        pthread_mutex_t mutex;
+        std::atomic<uint64_t> ready;  ///< kMagic once initialized.
+    };
+
+    /** @brief One entry. The slot at index slot_count is the recency sentinel. */
+    struct Slot {
+        uint32_t prev;
+        uint32_t next;
+        std::atomic<uint32_t> state;
+        uint64_t stamp;          ///< Last access; orders the rebuild.
+        K key;
+        V value;
+    };
+
+    static constexpr size_t SlotsOffset() { return (sizeof(Header) + 63) / 64 * 64; }
+
+    static size_t TableOffset(uint32_t slot_count) { return SlotsOffset() + sizeof(Slot) * (slot_count + 1); }
+
+    static size_t SegmentBytes(uint32_t slot_count, uint32_t table_size) {
+        return TableOffset(slot_count) + sizeof(position_t) * table_size;
+    }
+
+    std::string name_;
+    int fd_ = -1;
+    void* base_ = nullptr;
+    size_t bytes_ = 0;
+    Header* header_ = nullptr;
+    Slot* slots_ = nullptr;
+    detail::SlotIndex index_;
+    uint32_t sentinel_ = 0;
+    Hash hasher_;
+    KeyEqual equal_;
+
+    [[noreturn]] static void ThrowErrno(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    /* ---------------------------- structure ---------------------------- */
+
+    void Unlink(uint32_t i) {
+        slots_[slots_[i].prev].next = slots_[i].next;
+        slots_[slots_[i].next].prev = slots_[i].prev;
+    }
+
+    void PushFront(uint32_t i) {
+        uint32_t first = slots_[sentinel_].next;
+        slots_[i].prev = sentinel_;
+        slots_[i].next = first;
+        slots_[first].prev = i;
+        slots_[sentinel_].next = i;
+    }
+
+    size_t FindPosition(const K& key) const {
+        return index_.Find(hasher_(key), [&](uint32_t i) { return equal_(slots_[i].key, key); });
+    }
+
+    void InsertIndex(uint32_t i) { index_.Insert(hasher_(slots_[i].key), i); }
+
+    void PushFree(uint32_t i) {
+        slots_[i].next = header_->free_head;
+        header_->free_head = i;
+    }
+
+    uint32_t PopFree() {
+        uint32_t i = header_->free_head;
+        header_->free_head = slots_[i].next;
+        return i;
+    }
+
+    /** @brief Removes the resident slot found at table position `pos`. */
+    void Remove(size_t pos) {
+        uint32_t i = index_[pos];
+        slots_[i].state.store(kFree, std::memory_order_release);
+        index_.Erase(pos);
+        Unlink(i);
+        PushFree(i);
+        --header_->size;
+    }
+
+    /**
+     * @brief Rebuilds every derived structure from the slot states.
+     *
+     * Called with the mutex held after a previous holder died. Idempotent, so
+     * a crash during recovery is itself recovered by the next locker.
+     */
+    void Recover() {
+        index_.Clear();
+        std::vector<uint32_t> used;
+        for (uint32_t i = 0; i < header_->slot_count; ++i) {
+            if (slots_[i].state.load(std::memory_order_acquire) != kUsed) continue;
+            size_t pos = FindPosition(slots_[i].key);
+            if (pos == kNotFound) {
+                InsertIndex(i);
+                used.push_back(i);
+                continue;
+            }
+            uint32_t other = index_[pos];
+            uint32_t stale = slots_[other].stamp >= slots_[i].stamp ? i : other;
+            if (stale == other) {
+                index_.Replace(pos, i);
+                std::replace(used.begin(), used.end(), other, i);
+            }
+            slots_[stale].state.store(kFree, std::memory_order_release);
+        }
+
+        std::sort(used.begin(), used.end(),
+                  [this](uint32_t a, uint32_t b) { return slots_[a].stamp > slots_[b].stamp; });
+        while (used.size() > header_->capacity) {
+            uint32_t i = used.back();
+            used.pop_back();
+            slots_[i].state.store(kFree, std::memory_order_release);
+            index_.Erase(FindPosition(slots_[i].key));
+        }
+
+        slots_[sentinel_].prev = slots_[sentinel_].next = sentinel_;
+        for (auto it = used.rbegin(); it != used.rend(); ++it) PushFront(*it);
+        header_->free_head = kEmpty;
+        for (uint32_t i = 0; i < header_->slot_count; ++i) {
+            if (slots_[i].state.load(std::memory_order_relaxed) == kFree) PushFree(i);
+        }
+        header_->size = static_cast<uint32_t>(used.size());
+        for (uint32_t i : used) header_->clock = std::max(header_->clock, slots_[i].stamp);
+        header_->needs_recovery = 0;
+        ++header_->recoveries;
+    }
+
+    /** @brief Holds the segment mutex, recovering it if its owner died. */
+    class Guard {
+    private:
+        SharedLRUCache& cache_;
+
+    public:
+        explicit Guard(SharedLRUCache& cache) : cache_(cache) {
+            Header* header = cache_.header_;
+            int rc = pthread_mutex_lock(&header->mutex);
+            if (rc == EOWNERDEAD) {
+                header->needs_recovery = 1;
+                pthread_mutex_consistent(&header->mutex);
+            } else if (rc != 0) {
+                throw std::system_error(rc, std::generic_category(), "SharedLRUCache lock");
+            }
+            if (header->needs_recovery == 0) return;
+            try {
+                cache_.Recover();
+            } catch (...) {
+                // needs_recovery stays set, so the next locker retries.
+                pthread_mutex_unlock(&header->mutex);
+                throw;
+            }
+        }
+
+        ~Guard() { pthread_mutex_unlock(&cache_.header_->mutex); }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    /* ------------------------------ setup ------------------------------ */
+
+    void Initialize(uint32_t capacity, uint32_t slot_count, uint32_t table_size) {
+        header_->magic = kMagic;
+        header_->capacity = capacity;
+        header_->slot_count = slot_count;
+        header_->table_size = table_size;
+        header_->key_size = sizeof(K);
+        header_->value_size = sizeof(V);
+        header_->size = 0;
+        header_->clock = 0;
+        header_->recoveries = 0;
+        header_->needs_recovery = 0;
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        int rc = pthread_mutex_init(&header_->mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+        if (rc != 0) throw std::system_error(rc, std::generic_category(), "SharedLRUCache mutex");
+
+        header_->free_head = kEmpty;
+        for (uint32_t i = slot_count + 1; i-- > 0;) {
+            new (&slots_[i].state) std::atomic<uint32_t>(kFree);
+            if (i < slot_count) PushFree(i);
+        }
+        slots_[sentinel_].prev = slots_[sentinel_].next = sentinel_;
+        index_.Clear();
+        header_->ready.store(kMagic, std::memory_order_release);
+    }
+
+    void Map(size_t bytes) {
+        base_ = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (base_ == MAP_FAILED) {
+            base_ = nullptr;
+            ThrowErrno("SharedLRUCache mmap");
+        }
+        bytes_ = bytes;
+        header_ = static_cast<Header*>(base_);
+    }
+
+    void Close() {
+        if (base_ != nullptr) munmap(base_, bytes_);
+        if (fd_ >= 0) close(fd_);
+        base_ = nullptr;
+        fd_ = -1;
+    }
+
+public:
+    /**
+     * @brief Opens the segment `name`, creating and initializing it if needed.
+     *
+     * Creation is serialized with flock() on the segment, so any number of
+     * processes may start concurrently; a creator that died half way is
+     * detected by the missing ready marker and the segment is reinitialized.
+     *
+     * @param name Segment name for shm_open(), e.g. "/my-cache".
+     * @param capacity Maximum number of entries; must match an existing segment.
+     * @throws std::system_error on OS failures, std::invalid_argument if an
+     *         existing segment has a different capacity or entry layout.
+     */
+    SharedLRUCache(std::string name, uint32_t capacity) : name_(std::move(name)) {
+        if (capacity == 0 || capacity >= (1u << 30))
+            throw std::invalid_argument("SharedLRUCache capacity must be in [1, 2^30)");
+        const uint32_t slot_count = capacity + 1;
+        const uint32_t table_size = static_cast<uint32_t>(detail::SlotIndex::TableSize(slot_count));
+        const size_t bytes = SegmentBytes(slot_count, table_size);
+
+        fd_ = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0600);
+        if (fd_ < 0) ThrowErrno("SharedLRUCache shm_open");
+        try {
+            if (flock(fd_, LOCK_EX) != 0) ThrowErrno("SharedLRUCache flock");
+            struct stat st;
+            if (fstat(fd_, &st) != 0) ThrowErrno("SharedLRUCache fstat");
+            bool fresh = static_cast<size_t>(st.st_size) < sizeof(Header);
+            if (fresh && ftruncate(fd_, static_cast<off_t>(bytes)) != 0) ThrowErrno("SharedLRUCache ftruncate");
+            if (!fresh && static_cast<size_t>(st.st_size) != bytes) {
+                flock(fd_, LOCK_UN);
+                throw std::invalid_argument("SharedLRUCache segment has a different capacity");
+            }
+            Map(bytes);
+            slots_ = reinterpret_cast<Slot*>(static_cast<char*>(base_) + SlotsOffset());
+            index_ = detail::SlotIndex(reinterpret_cast<position_t*>(static_cast<char*>(base_) + TableOffset(slot_count)),
+                                       table_size);
+            sentinel_ = slot_count;
+
+            if (header_->ready.load(std::memory_order_acquire) != kMagic) {
+                Initialize(capacity, slot_count, table_size);
+            } else if (header_->capacity != capacity || header_->key_size != sizeof(K) ||
+                       header_->value_size != sizeof(V)) {
+                flock(fd_, LOCK_UN);
+                throw std::invalid_argument("SharedLRUCache segment layout mismatch");
+            }
+            flock(fd_, LOCK_UN);
+        } catch (...) {
+            Close();
+            throw;
+        }
+    }
+
+    SharedLRUCache(const SharedLRUCache&) = delete;
+    SharedLRUCache& operator=(const SharedLRUCache&) = delete;
+
+    /**
+     * @brief Unmaps the segment. The segment itself persists until Remove().
+     */
+    ~SharedLRUCache() { Close(); }
+
+    /**
+     * @brief Deletes the named segment; processes that mapped it keep their mapping.
+     */
+    static bool Remove(const std::string& name) { return shm_unlink(name.c_str()) == 0; }
+
+    /**
+     * @brief Returns a copy of the value and marks the entry most recent.
+     */
+    std::optional<V> get(const K& key) {
+        Guard guard(*this);
+        size_t pos = FindPosition(key);
+        if (pos == kNotFound) return std::nullopt;
+        uint32_t i = index_[pos];
+        slots_[i].stamp = ++header_->clock;
+        Unlink(i);
+        PushFront(i);
+        return slots_[i].value;
+    }
+
+    /**
+     * @brief Inserts or replaces a value, evicting the least recently used
+     *        entry when full.
+     */
+    void put(const K& key, const V& value) {
+        Guard guard(*this);
+        size_t pos = FindPosition(key);
+        if (pos == kNotFound && header_->size >= header_->capacity) {
+            Remove(FindPosition(slots_[slots_[sentinel_].prev].key));
+        }
+
+        // There is always a free slot: at most capacity of capacity + 1 are used.
+        uint32_t slot = PopFree();
+        slots_[slot].key = key;
+        slots_[slot].value = value;
+        slots_[slot].stamp = ++header_->clock;
+        slots_[slot].state.store(kUsed, std::memory_order_release);
+
+        if (pos != kNotFound) {
+            uint32_t old = index_[pos];
+            index_.Replace(pos, slot);
+            slots_[old].state.store(kFree, std::memory_order_release);
+            Unlink(old);
+            PushFree(old);
+        } else {
+            InsertIndex(slot);
+            ++header_->size;
+        }
+        PushFront(slot);
+    }
+
+    /**
+     * @brief Removes a key.
+     * @return True if the key was present.
+     */
+    bool erase(const K& key) {
+        Guard guard(*this);
+        size_t pos = FindPosition(key);
+        if (pos == kNotFound) return false;
+        Remove(pos);
+        return true;
+    }
+
+    bool contains(const K& key) {
+        Guard guard(*this);
+        return FindPosition(key) != kNotFound;
+    }
+
+    size_t size() {
+        Guard guard(*this);
+        return header_->size;
+    }
+
+    size_t capacity() const { return header_->capacity; }
+
+    /**
+     * @brief Number of times the structure was rebuilt after a process died
+     *        holding the lock.
+     */
+    uint64_t recoveries() {
+        Guard guard(*this);
+        return header_->recoveries;
+    }
+
+    const std::string& name() const { return name_; }
+};
+
+} // namespace Collections
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file slot_index.hpp
+ * @brief Open-addressing indexes of 32-bit slot numbers, shared by the
+ *        array-backed caches.
+ */
+
+namespace Collections {
+
+namespace detail {
+
+/**
+ * @brief 64-bit finalizer (MurmurHash3 fmix64).
+ *
+ * Spreads every input bit over the output, so identity hashes such as
+ * std::hash<uint64_t> still give well-distributed low bits.
+ */
+inline uint64_t MixHash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/** @brief Table size for `count` slots: a power of two at <= 80% load. */
+constexpr size_t SlotTableSize(size_t count) {
+    size_t size = 1;
+    while (size < count + count / 4 + 1) size *= 2;
+    return size;
+}
+
+/**
+ * @brief A linear-probing hash index mapping keys to 32-bit slot numbers.
+ *
+ * The index does not own its table, so it works over an inline array, a
+ * heap array or a shared-memory segment alike; keys stay in the caller's
+ * slots. Each position packs a slot number with 32 bits of the key's mixed
+ * hash (see MixHash(), so sequential and strided keys do not form primary
+ * clusters). Probes compare the stored hash before calling back into the
+ * caller's slots, and deletion shifts the following run back using the
+ * stored hashes alone, leaving no tombstones, so it never calls back into
+ * the caller's hash. Positions take 8 bytes; CompactSlotIndex halves that.
+ */
+class SlotIndex {
+public:
+    using position_t = uint64_t;
+
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+    static constexpr size_t kNotFound = SIZE_MAX;
+
+    SlotIndex() = default;
+
+    /**
+     * @param table Storage of `size` positions; `size` must be a power of two
+     *        larger than the number of slots ever indexed at once.
+     */
+    SlotIndex(position_t* table, size_t size) : table_(table), mask_(size - 1) {}
+
+    static constexpr size_t TableSize(size_t count) { return SlotTableSize(count); }
+
+    /** @brief Marks every position empty. */
+    void Clear() { std::fill(table_, table_ + mask_ + 1, kVacant); }
+
+    /**
+     * @brief Returns the position holding the slot for which `matches(slot)`
+     *        is true, or kNotFound.
+     *
+     * @param hash The key's hash, before mixing.
+     */
+    template <typename Matches>
+    size_t Find(uint64_t hash, Matches matches) const {
+        uint32_t tag = Tag(hash);
+        for (size_t pos = Home(tag);; pos = Next(pos)) {
+            position_t entry = table_[pos];
+            if (entry == kVacant) return kNotFound;
+            if (static_cast<uint32_t>(entry >> 32) == tag && matches(static_cast<uint32_t>(entry))) return pos;
+        }
+    }
+
+    /** @brief Indexes a slot whose key is not present yet. */
+    void Insert(uint64_t hash, uint32_t slot) {
+        uint32_t tag = Tag(hash);
+        size_t pos = Home(tag);
+        while (table_[pos] != kVacant) pos = Next(pos);
+        table_[pos] = Pack(tag, slot);
+    }
+
+    /** @brief Points a found position at another slot holding the same key. */
+    void Replace(size_t pos, uint32_t slot) {
+        table_[pos] = (table_[pos] & ~position_t{UINT32_MAX}) | slot;
+    }
+
+    /**
+     * @brief Empties position `pos` and shifts the following run back so
+     *        every slot stays reachable from its home position.
+     */
+    void Erase(size_t pos) {
+        size_t hole = pos;
+        for (pos = Next(hole); table_[pos] != kVacant; pos = Next(pos)) {
+            size_t home = Home(static_cast<uint32_t>(table_[pos] >> 32));
+            // Move the entry into the hole unless its home lies after the hole.
+            if (((pos - home) & mask_) >= ((pos - hole) & mask_)) {
+                table_[hole] = table_[pos];
+                hole = pos;
+            }
+        }
+        table_[hole] = kVacant;
+    }
+
+    /** @brief Slot number at a position returned by Find(). */
+    uint32_t operator[](size_t pos) const { return static_cast<uint32_t>(table_[pos]); }
+
+    size_t size() const { return mask_ + 1; }
+
+private:
+    static constexpr position_t kVacant = UINT64_MAX;
+
+    position_t* table_ = nullptr;
+    size_t mask_ = 0;
+
+    static uint32_t Tag(uint64_t hash) { return static_cast<uint32_t>(MixHash(hash)); }
+    static position_t Pack(uint32_t tag, uint32_t slot) { return (position_t{tag} << 32) | slot; }
+    size_t Home(uint32_t tag) const { return tag & mask_; }
+    size_t Next(size_t pos) const { return (pos + 1) & mask_; }
+};
+
+/**
+ * @brief A SlotIndex whose positions hold only the 4-byte slot number.
+ *
+ * Homes still come from the mixed hash, so clusters stay short, but every
+ * probe compares the caller's key and deletion rehashes the keys of the run
+ * it shifts back. The hash must therefore not throw.
+ */
+class CompactSlotIndex {
+public:
+    using position_t = uint32_t;
+
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+    static constexpr size_t kNotFound = SIZE_MAX;
+
+    CompactSlotIndex() = default;
+
+    /** @copydoc SlotIndex::SlotIndex(SlotIndex::position_t*, size_t) */
+    CompactSlotIndex(position_t* table, size_t size) : table_(table), mask_(size - 1) {}
+
+    static constexpr size_t TableSize(size_t count) { return SlotTableSize(count); }
+
+    void Clear() { std::fill(table_, table_ + mask_ + 1, kEmpty); }
+
+    /** @copydoc SlotIndex::Find */
+    template <typename Matches>
+    size_t Find(uint64_t hash, Matches matches) const {
+        for (size_t pos = Home(hash);; pos = Next(pos)) {
+            if (table_[pos] == kEmpty) return kNotFound;
+            if (matches(table_[pos])) return pos;
+        }
+    }
+
+    /** @brief Indexes a slot whose key is not present yet. */
+    void Insert(uint64_t hash, uint32_t slot) {
+        size_t pos = Home(hash);
+        while (table_[pos] != kEmpty) pos = Next(pos);
+        table_[pos] = slot;
+    }
+
+    /**
+     * @brief Empties position `pos` and shifts the following run back.
+     *
+     * @param hash_of Returns the unmixed hash of the key held in a slot.
+     */
+    template <typename HashOf>
+    void Erase(size_t pos, HashOf hash_of) {
+        size_t hole = pos;
+        for (pos = Next(hole); table_[pos] != kEmpty; pos = Next(pos)) {
+            size_t home = Home(hash_of(table_[pos]));
+            if (((pos - home) & mask_) >= ((pos - hole) & mask_)) {
+                table_[hole] = table_[pos];
+                hole = pos;
+            }
+        }
+        table_[hole] = kEmpty;
+    }
+
+    uint32_t operator[](size_t pos) const { return table_[pos]; }
+
+    size_t size() const { return mask_ + 1; }
+
+private:
+    position_t* table_ = nullptr;
+    size_t mask_ = 0;
+
+    size_t Home(uint64_t hash) const { return MixHash(hash) & mask_; }
+    size_t Next(size_t pos) const { return (pos + 1) & mask_; }
+};
+
+} // namespace detail
+
+} // namespace Collections
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include "lru_k_replacer.hpp"
+
+/**
+ * @file striped_lru_k_cache.hpp
+ * @brief Thread-safe LRU-K cache sharded by key.
+ */
+
+namespace Collections {
+
+/**
+ * @brief A concurrent LRU-K cache with per-shard locks and a global clock.
+ *
+ * Keys are hashed to shards. Each shard is a small LRU-K cache of its own
+ * (hash index and detail::LRUKTracker, as in LRU_K_Cache) behind its own
+ * mutex, so Get() and Put() on different shards never contend. Access
+ * timestamps come from one relaxed atomic counter shared by all shards
+ * (detail::SharedClock); they are drawn under the shard lock, so each shard
+ * sees them in increasing order and the ranks of different shards are
+ * comparable.
+ *
+ * Capacity is global. Every shard publishes the rank of its next victim in
+ * an atomic (sub-K entries by first access, ahead of the others by K-th most
+ * recent access). The eviction pass, serialized by one mutex and run only
+ * when an insertion finds the cache full, picks the shard with the lowest
+ * rank and evicts its head, so the victim is the same one a single LRU-K
+ * cache would pick, up to accesses racing with the pass. Racing insertions
+ * may push the size above the capacity by at most the number of concurrent
+ * Put() calls; the next insertion evicts the excess.
+ *
+ * @tparam K Key type (must be hashable and comparable).
+ * @tparam V Value type (copied out on every hit).
+ * @tparam HistoryDepth K fixed at compile time, or kRuntimeHistoryDepth to
+ *         pass it to the constructor.
+ */
+template <HashableAndComparable K, typename V, size_t HistoryDepth = kRuntimeHistoryDepth>
+class StripedLRUKCache {
+private:
+    struct Node {
+        K key_;
+        V value_;
+        detail::LRUKHook<HistoryDepth> hook_;
+
+        Node(K key, V value, size_t k) : key_(std::move(key)), value_(std::move(value)), hook_(k) {}
+    };
+
+    struct NodeTraits {
+        detail::LRUKHook<HistoryDepth>& hook(Node* node) const { return node->hook_; }
+        const K& key(Node* node) const { return node->key_; }
+    };
+
+    using Tracker = detail::LRUKTracker<Node*, K, HistoryDepth, NodeTraits, detail::SharedClock>;
+
+    /** @brief Rank published by an empty shard. */
+    static constexpr uint64_t kEmptyRank = std::numeric_limits<uint64_t>::max();
+
+    /**
+     * @brief One lock-protected LRU-K partition.
+     */
+    struct alignas(64) Shard {
+        std::mutex mutex_;
+        std::unordered_map<K, Node*> index_;
+        Tracker tracker_;
+        std::atomic<uint64_t> victim_rank_{kEmptyRank};  ///< Rank of the tracker's victim; written under mutex_.
+
+        Shard(size_t k, std::atomic<timestamp_t>* clock) : tracker_(k, NodeTraits(), detail::SharedClock(clock)) {}
+
+        ~Shard() {
+            for (auto& [_, node] : index_) delete node;
+        }
+
+        /** @brief Unlinks and frees a node. */
+        void Erase(Node* node) {
+            tracker_.Dequeue(node);
+            index_.erase(node->key_);
+            delete node;
+        }
+
+        /** @brief Publishes the rank of the current victim to the eviction pass. */
+        void PublishRank() {
+            uint64_t rank = tracker_.empty() ? kEmptyRank : tracker_.Rank(tracker_.Victim());
+            victim_rank_.store(rank, std::memory_order_relaxed);
+        }
+    };
+
+    size_t capacity_;
+    size_t k_;
+    size_t shard_mask_;
+    std::atomic<timestamp_t> clock_{0};  ///< Global logical time, shared by the shards' trackers.
+    mutable std::deque<Shard> shards_;   ///< Mutable: contains() locks a shard.
+    std::hash<K> hasher_;
+    std::atomic<size_t> size_{0};
+    std::mutex eviction_;                ///< Serializes eviction passes.
+
+    Shard& ShardOf(const K& key) const {
+        // Mix the hash so keys with identity hashes still spread over shards.
+        uint64_t hash = hasher_(key) * 0x9E3779B97F4A7C15ULL;
+        return shards_[(hash >> 32) & shard_mask_];
+    }
+
+    void UpdateLocked(Shard& shard, Node* node, V&& value, AccessType type) {
+        shard.tracker_.Access(node, type);
+        node->value_ = std::move(value);
+        shard.PublishRank();
+    }
+
+    /**
+     * @brief Evicts globally ranked victims until at most `target` entries remain.
+     */
+    void EvictDownTo(size_t target) {
+        std::lock_guard<std::mutex> pass(eviction_);
+        while (size_.load(std::memory_order_relaxed) > target) {
+            size_t best = 0;
+            uint64_t best_rank = kEmptyRank;
+            for (size_t s = 0; s <= shard_mask_; ++s) {
+                uint64_t rank = shards_[s].victim_rank_.load(std::memory_order_relaxed);
+                if (rank < best_rank) {
+                    best_rank = rank;
+                    best = s;
+                }
+            }
+            if (best_rank == kEmptyRank) return;
+
+            Shard& shard = shards_[best];
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            if (shard.tracker_.empty()) continue;  // emptied by Remove() since the scan
+            shard.Erase(shard.tracker_.Victim());
+            shard.PublishRank();
+            size_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    /**
+     * @brief Creates an empty cache whose K is its compile-time HistoryDepth,
+     *        with four shards per hardware thread.
+     *
+     * @param capacity Maximum number of entries.
+     */
+    explicit StripedLRUKCache(size_t capacity)
+        requires(HistoryDepth != kRuntimeHistoryDepth)
+        : StripedLRUKCache(capacity, HistoryDepth) {}
+
+    /**
+     * @brief Creates an empty cache.
+     *
+     * @param capacity Maximum number of entries.
+     * @param k Number of recent accesses to track per key; must equal
+     *        HistoryDepth unless the depth is chosen at runtime.
+     * @param shards Number of shards; rounded up to a power of two.
+     *        Defaults to four per hardware thread.
+     */
+    StripedLRUKCache(size_t capacity, size_t k, size_t shards = 0)
+        : capacity_(capacity),
+          k_(k),
+          shard_mask_(std::bit_ceil(shards != 0 ? shards
+                                                : 4 * std::max(1u, std::thread::hardware_concurrency())) - 1) {
+        if (capacity_ == 0) {
+            THROW_RUNTIME("Striped LRU-K Cache capacity must be positive");
+        }
+        if (k_ == 0 || k_ > std::numeric_limits<uint32_t>::max()) {
+            THROW_RUNTIME("Striped LRU-K Cache needs K >= 1");
+        }
+        if (HistoryDepth != kRuntimeHistoryDepth && k_ != HistoryDepth) {
+            THROW_RUNTIME("Striped LRU-K Cache K does not match its HistoryDepth");
+        }
+        for (size_t s = 0; s <= shard_mask_; ++s) shards_.emplace_back(k_, &clock_);
+    }
+
+    StripedLRUKCache(const StripedLRUKCache&) = delete;
+    StripedLRUKCache& operator=(const StripedLRUKCache&) = delete;
+
+    /**
+     * @brief Retrieves a copy of the value and records the access.
+     *
+     * @param type Access type hint, as for LRU_K_Cache::Get().
+     * @return The value, or std::nullopt on a miss.
+     */
+    std::optional<V> Get(const K& key, AccessType type = AccessType::kUnknown) {
+        Shard& shard = ShardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        auto it = shard.index_.find(key);
+        if (it == shard.index_.end()) return std::nullopt;
+
+        Node* node = it->second;
+        shard.tracker_.Access(node, type);
+        shard.PublishRank();
+        return node->value_;
+    }
+
+    /**
+     * @brief Inserts or updates a value.
+     *
+     * A new key first makes room, so it is never its own victim.
+     *
+     * @param type Access type hint, as for LRU_K_Cache::Put().
+     */
+    void Put(K key, V value, AccessType type = AccessType::kUnknown) {
+        Shard& shard = ShardOf(key);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            auto it = shard.index_.find(key);
+            if (it != shard.index_.end()) {
+                UpdateLocked(shard, it->second, std::move(value), type);
+                return;
+            }
+        }
+
+        if (size_.load(std::memory_order_relaxed) >= capacity_) EvictDownTo(capacity_ - 1);
+
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        auto it = shard.index_.find(key);
+        if (it != shard.index_.end()) {  // inserted by another thread meanwhile
+            UpdateLocked(shard, it->second, std::move(value), type);
+            return;
+        }
+        Node* node = new Node(std::move(key), std::move(value), k_);
+        shard.index_.emplace(node->key_, node);
+        shard.tracker_.Admit(node, type);
+        shard.tracker_.Enqueue(node);
+        shard.PublishRank();
+        size_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Removes a key.
+     *
+     * @return True if the key was present.
+     */
+    bool Remove(const K& key) {
+        Shard& shard = ShardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        auto it = shard.index_.find(key);
+        if (it == shard.index_.end()) return false;
+        shard.Erase(it->second);
+        shard.PublishRank();
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Checks whether a key is cached; does not count as an access.
+     */
+    bool contains(const K& key) const {
+        Shard& shard = ShardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return shard.index_.find(key) != shard.index_.end();
+    }
+
+    /**
+     * @brief Returns the number of cached entries (a snapshot under concurrency).
+     */
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Returns the number of shards.
+     */
+    size_t shard_count() const { return shard_mask_ + 1; }
+};
+
+} // namespace Collections
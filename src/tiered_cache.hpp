@@ -0,0 +1,497 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "cache.hpp"
+#include "serialization.hpp"
+
+/**
+ * @file tiered_cache.hpp
+ * @brief Two-tier cache: an in-memory LRUCache backed by a local-disk overflow tier.
+ */
+
+namespace Collections {
+
+/**
+ * @brief Tuning knobs of the disk tier.
+ */
+struct DiskTierOptions {
+    std::string directory;                       ///< Directory holding segment files.
+    size_t segment_bytes = 64u << 20;            ///< Size at which a segment is sealed.
+    size_t max_segments = 16;                    ///< Oldest segment is dropped beyond this.
+    size_t write_batch_bytes = 1u << 20;         ///< Buffered bytes before a write is issued.
+    size_t read_threads = 3;                     ///< Helper threads of ReadMany(); 0 reads inline.
+};
+
+namespace detail {
+
+/**
+ * @brief A fixed set of worker threads running submitted tasks in FIFO order.
+ */
+class ReadPool {
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::packaged_task<void()>> tasks_;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+
+    void Run() {
+        while (true) {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    explicit ReadPool(size_t threads) {
+        threads_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) threads_.emplace_back([this] { Run(); });
+    }
+
+    ReadPool(const ReadPool&) = delete;
+    ReadPool& operator=(const ReadPool&) = delete;
+
+    /** @brief Finishes the queued tasks, then joins the threads. */
+    ~ReadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        for (std::thread& thread : threads_) thread.join();
+    }
+
+    /**
+     * @brief Queues a task; the future rethrows anything it throws.
+     */
+    std::future<void> Submit(std::function<void()> job) {
+        std::packaged_task<void()> task(std::move(job));
+        std::future<void> done = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        ready_.notify_one();
+        return done;
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Log-structured key-value store on local disk with an in-memory index.
+ *
+ * Records are appended to the active segment through a write buffer that is
+ * flushed with one pwrite() per batch. Segments are evicted in FIFO order:
+ * when the segment count exceeds DiskTierOptions::max_segments the oldest file
+ * is deleted together with every index entry still pointing into it.
+ * Overwritten or erased records stay in their segment as garbage until that
+ * segment is dropped.
+ *
+ * Segment files are private to one instance; they are removed on destruction.
+ *
+ * @tparam K Key type (must have a Codec).
+ * @tparam V Value type (must have a Codec).
+ */
+template <typename K, typename V>
+    requires Serializable<K> && Serializable<V>
+class DiskTier {
+private:
+    /** @brief Position of a record inside a segment file. */
+    struct Location {
+        uint64_t segment_id;
+        uint64_t offset;
+        uint64_t length;
+    };
+
+    /** @brief An open segment file. */
+    struct Segment {
+        uint64_t id;
+        int fd;
+        uint64_t size;       ///< Bytes already written to the file.
+        std::vector<K> keys; ///< Keys appended to this segment, for FIFO eviction.
+    };
+
+    DiskTierOptions options_;
+    std::deque<Segment> segments_;           ///< Oldest first; back() is active.
+    std::unordered_map<K, Location> index_;  ///< Live records.
+    std::string write_buffer_;               ///< Pending bytes of the active segment.
+    uint64_t next_segment_id_ = 0;
+    mutable std::unique_ptr<detail::ReadPool> read_pool_;  ///< Started by the first multi-segment ReadMany().
+
+    std::string SegmentPath(uint64_t id) const {
+        return (std::filesystem::path(options_.directory) /
+                ("segment-" + std::to_string(id) + ".log")).string();
+    }
+
+    void OpenSegment() {
+        uint64_t id = next_segment_id_++;
+        int fd = ::open(SegmentPath(id).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) throw std::runtime_error("Cannot create disk tier segment " + SegmentPath(id));
+        segments_.push_back(Segment{id, fd, 0, {}});
+    }
+
+    void DropOldestSegment() {
+        Segment& oldest = segments_.front();
+        for (const K& key : oldest.keys) {
+            auto it = index_.find(key);
+            if (it != index_.end() && it->second.segment_id == oldest.id) index_.erase(it);
+        }
+        ::close(oldest.fd);
+        ::unlink(SegmentPath(oldest.id).c_str());
+        segments_.pop_front();
+    }
+
+    Segment& Active() { return segments_.back(); }
+
+    static void WriteFully(int fd, const char* data, size_t size, uint64_t offset) {
+        while (size > 0) {
+            ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+            if (written < 0) throw std::runtime_error("Disk tier write failed");
+            data += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<uint64_t>(written);
+        }
+    }
+
+    static bool ReadFully(int fd, char* data, size_t size, uint64_t offset) {
+        while (size > 0) {
+            ssize_t got = ::pread(fd, data, size, static_cast<off_t>(offset));
+            if (got <= 0) return false;
+            data += got;
+            size -= static_cast<size_t>(got);
+            offset += static_cast<uint64_t>(got);
+        }
+        return true;
+    }
+
+    static std::optional<V> Decode(const char* data, size_t size, const K& expected) {
+        BufferReader reader(data, size);
+        K key;
+        V value;
+        if (!Codec<K>::Read(reader, key) || !Codec<V>::Read(reader, value) || !(key == expected))
+            return std::nullopt;
+        return value;
+    }
+
+    const Segment* FindSegment(uint64_t id) const {
+        if (segments_.empty() || id < segments_.front().id) return nullptr;
+        size_t position = static_cast<size_t>(id - segments_.front().id);
+        return position < segments_.size() ? &segments_[position] : nullptr;
+    }
+
+    /**
+     * @brief True if the record has not been written to the file yet.
+     */
+    bool Buffered(const Location& location) const {
+        return location.segment_id == segments_.back().id &&
+               location.offset >= segments_.back().size;
+    }
+
+    std::optional<V> ReadBuffered(const Location& location, const K& key) const {
+        return Decode(write_buffer_.data() + (location.offset - segments_.back().size),
+                      location.length, key);
+    }
+
+public:
+    /**
+     * @brief Creates the tier and its first segment.
+     *
+     * @param options Directory and sizing; the directory is created if needed.
+     * @throws std::runtime_error if the segment file cannot be created.
+     */
+    explicit DiskTier(DiskTierOptions options) : options_(std::move(options)) {
+        if (options_.max_segments == 0) throw std::invalid_argument("Disk tier needs at least one segment");
+        std::filesystem::create_directories(options_.directory);
+        OpenSegment();
+    }
+
+    DiskTier(const DiskTier&) = delete;
+    DiskTier& operator=(const DiskTier&) = delete;
+
+    /**
+     * @brief Closes and deletes every segment file.
+     */
+    ~DiskTier() {
+        for (Segment& segment : segments_) {
+            ::close(segment.fd);
+            ::unlink(SegmentPath(segment.id).c_str());
+        }
+    }
+
+    /**
+     * @brief Appends a record, replacing any earlier record of the same key.
+     */
+    void Append(const K& key, const V& value) {
+        std::string record;
+        BufferWriter writer(record);
+        Codec<K>::Write(writer, key);
+        Codec<V>::Write(writer, value);
+
+        if (Active().size + write_buffer_.size() + record.size() > options_.segment_bytes &&
+            Active().size + write_buffer_.size() > 0) {
+            Flush();
+            OpenSegment();
+            if (segments_.size() > options_.max_segments) DropOldestSegment();
+        }
+
+        Segment& active = Active();
+        index_[key] = Location{active.id, active.size + write_buffer_.size(), record.size()};
+        active.keys.push_back(key);
+        write_buffer_ += record;
+        if (write_buffer_.size() >= options_.write_batch_bytes) Flush();
+    }
+
+    /**
+     * @brief Reads the value of a key, if the tier holds it.
+     */
+    std::optional<V> Read(const K& key) const {
+        auto it = index_.find(key);
+        if (it == index_.end()) return std::nullopt;
+        const Location& location = it->second;
+        if (Buffered(location)) return ReadBuffered(location, key);
+
+        const Segment* segment = FindSegment(location.segment_id);
+        if (segment == nullptr) return std::nullopt;
+        std::string record(location.length, '\0');
+        if (!ReadFully(segment->fd, record.data(), record.size(), location.offset)) return std::nullopt;
+        return Decode(record.data(), record.size(), key);
+    }
+
+    /**
+     * @brief Reads several keys, reading different segments concurrently.
+     *
+     * Records are grouped per segment and sorted by offset; adjacent records
+     * are fetched with a single pread(). The calling thread reads one
+     * segment itself and hands the others to a pool of
+     * DiskTierOptions::read_threads threads, started on first use; a batch
+     * within one segment never leaves the calling thread.
+     *
+     * @return One optional per key, in the order of @p keys.
+     */
+    std::vector<std::optional<V>> ReadMany(const std::vector<K>& keys) const {
+        std::vector<std::optional<V>> values(keys.size());
+        std::unordered_map<uint64_t, std::vector<std::pair<Location, size_t>>> per_segment;
+
+        for (size_t i = 0; i < keys.size(); ++i) {
+            auto it = index_.find(keys[i]);
+            if (it == index_.end()) continue;
+            if (Buffered(it->second)) {
+                values[i] = ReadBuffered(it->second, keys[i]);
+            } else {
+                per_segment[it->second.segment_id].emplace_back(it->second, i);
+            }
+        }
+
+        std::vector<std::function<void()>> reads;
+        for (auto& [segment_id, records] : per_segment) {
+            const Segment* segment = FindSegment(segment_id);
+            if (segment == nullptr) continue;
+            reads.push_back([&, fd = segment->fd, &records = records] {
+                std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+                    return a.first.offset < b.first.offset;
+                });
+                size_t first = 0;
+                while (first < records.size()) {
+                    // Extend the run while records are contiguous on disk.
+                    size_t last = first;
+                    while (last + 1 < records.size() &&
+                           records[last + 1].first.offset ==
+                               records[last].first.offset + records[last].first.length) {
+                        ++last;
+                    }
+                    uint64_t start = records[first].first.offset;
+                    uint64_t end = records[last].first.offset + records[last].first.length;
+                    std::string run(static_cast<size_t>(end - start), '\0');
+                    if (ReadFully(fd, run.data(), run.size(), start)) {
+                        for (size_t r = first; r <= last; ++r) {
+                            const auto& [location, slot] = records[r];
+                            values[slot] = Decode(run.data() + (location.offset - start),
+                                                  location.length, keys[slot]);
+                        }
+                    }
+                    first = last + 1;
+                }
+            });
+        }
+        if (reads.empty()) return values;
+
+        if (reads.size() > 1 && options_.read_threads > 0 && read_pool_ == nullptr) {
+            read_pool_ = std::make_unique<detail::ReadPool>(options_.read_threads);
+        }
+        std::vector<std::future<void>> pending;
+        for (size_t i = 1; i < reads.size(); ++i) {
+            if (read_pool_ != nullptr) pending.push_back(read_pool_->Submit(std::move(reads[i])));
+            else reads[i]();
+        }
+        std::exception_ptr error;
+        try {
+            reads[0]();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        for (std::future<void>& read : pending) {
+            try {
+                read.get();  // always wait: the tasks reference this frame
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+        return values;
+    }
+
+    /**
+     * @brief Forgets a key; its record becomes garbage in its segment.
+     * @return True if the key was present.
+     */
+    bool Erase(const K& key) { return index_.erase(key) > 0; }
+
+    /**
+     * @brief Writes the pending batch to the active segment.
+     */
+    void Flush() {
+        if (write_buffer_.empty()) return;
+        Segment& active = Active();
+        WriteFully(active.fd, write_buffer_.data(), write_buffer_.size(), active.size);
+        active.size += write_buffer_.size();
+        write_buffer_.clear();
+    }
+
+    bool contains(const K& key) const { return index_.find(key) != index_.end(); }
+
+    /** @brief Number of live records. */
+    size_t size() const { return index_.size(); }
+
+    /** @brief Number of segment files, including the active one. */
+    size_t segment_count() const { return segments_.size(); }
+};
+
+/**
+ * @brief An in-memory Cache whose evictions are demoted to a DiskTier.
+ *
+ * Lookups that miss memory but hit disk promote the entry back into memory,
+ * which may in turn demote the current least recently used entry.
+ *
+ * Demotion runs inside the Cache eviction listener. If the disk write
+ * fails (ENOSPC, EIO), the std::runtime_error propagates out of put() or
+ * get() and the entry being demoted is lost; both tiers stay consistent.
+ *
+ * @tparam K Key type.
+ * @tparam V Value type.
+ * @tparam Policy Replacement policy of the memory tier (see cache.hpp).
+ */
+template <typename K, typename V, typename Policy = LRUPolicy>
+    requires Serializable<K> && Serializable<V>
+class TieredCache {
+private:
+    Cache<K, V, Policy> memory_;
+    DiskTier<K, V> disk_;
+
+    void Promote(const K& key, V value) {
+        disk_.Erase(key);
+        memory_.put(key, std::move(value));
+    }
+
+public:
+    /**
+     * @brief Creates the cache.
+     *
+     * @param memory_capacity Number of entries held in memory.
+     * @param options Disk tier configuration.
+     */
+    TieredCache(size_t memory_capacity, DiskTierOptions options)
+        : memory_(memory_capacity), disk_(std::move(options)) {
+        memory_.set_eviction_listener([this](K&& key, V&& value) { disk_.Append(key, value); });
+    }
+
+    TieredCache(const TieredCache&) = delete;
+    TieredCache& operator=(const TieredCache&) = delete;
+
+    /**
+     * @brief Looks in memory, then on disk; disk hits are promoted.
+     */
+    std::optional<V> get(const K& key) {
+        std::optional<V> value = memory_.get(key);
+        if (value.has_value()) return value;
+
+        value = disk_.Read(key);
+        if (value.has_value()) Promote(key, *value);
+        return value;
+    }
+
+    /**
+     * @brief Looks several keys up; disk misses of the memory tier are read
+     *        ahead asynchronously as one batch and promoted.
+     *
+     * @return One optional per key, in the order of @p keys.
+     */
+    std::vector<std::optional<V>> get_many(const std::vector<K>& keys) {
+        std::vector<std::optional<V>> values(keys.size());
+        std::vector<K> disk_keys;
+        std::vector<size_t> disk_slots;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            values[i] = memory_.get(keys[i]);
+            if (!values[i].has_value() && disk_.contains(keys[i])) {
+                disk_keys.push_back(keys[i]);
+                disk_slots.push_back(i);
+            }
+        }
+
+        std::vector<std::optional<V>> loaded = disk_.ReadMany(disk_keys);
+        for (size_t i = 0; i < loaded.size(); ++i) {
+            if (!loaded[i].has_value()) continue;
+            values[disk_slots[i]] = loaded[i];
+            Promote(disk_keys[i], std::move(*loaded[i]));
+        }
+        return values;
+    }
+
+    /**
+     * @brief Inserts into memory; a stale disk copy is dropped.
+     */
+    void put(K key, V value) {
+        disk_.Erase(key);
+        memory_.put(std::move(key), std::move(value));
+    }
+
+    /**
+     * @brief Writes buffered demotions to disk.
+     */
+    void flush() { disk_.Flush(); }
+
+    size_t memory_size() const { return memory_.size(); }
+
+    size_t disk_size() const { return disk_.size(); }
+
+    const DiskTier<K, V>& disk() const { return disk_; }
+};
+
+} // namespace Collections
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @file transparent_hash.hpp
+ * @brief Hash and equality functors enabling heterogeneous ("transparent") lookup.
+ *
+ * With these functors a cache keyed by std::string can be queried with a
+ * std::string_view or a const char* without materializing a std::string, and
+ * callers that already know the hash of a key can pass it in with Prehashed.
+ */
+
+namespace Collections {
+
+/**
+ * @brief A lookup key bundled with its precomputed hash.
+ *
+ * The hash must have been computed with the same hasher the container uses,
+ * e.g. `cache.hash_function()(key)`.
+ *
+ * @tparam Q The type of the lookup key.
+ */
+template <typename Q>
+struct Prehashed {
+    const Q& key;     ///< The lookup key (not owned).
+    size_t hash;      ///< Hash of @ref key.
+};
+
+template <typename Q>
+Prehashed(const Q&, size_t) -> Prehashed<Q>;
+
+template <typename T>
+struct IsPrehashed : std::false_type {};
+
+template <typename Q>
+struct IsPrehashed<Prehashed<Q>> : std::true_type {};
+
+/**
+ * @brief Returns the key wrapped by a Prehashed, or the argument itself.
+ */
+template <typename T>
+constexpr const auto& UnwrapKey(const T& value) {
+    if constexpr (IsPrehashed<T>::value) {
+        return value.key;
+    } else {
+        return value;
+    }
+}
+
+/**
+ * @brief Transparent hasher for key type K.
+ *
+ * For string keys every type convertible to the matching std::basic_string_view
+ * hashes the same way as the key itself (the standard guarantees that
+ * std::hash<std::string> and std::hash<std::string_view> agree). For other
+ * key types only K and Prehashed lookups are accepted.
+ *
+ * @tparam K The container's key type.
+ */
+template <typename K>
+struct TransparentHash {
+    using is_transparent = void;
+
+    size_t operator()(const K& key) const { return std::hash<K>{}(key); }
+
+    template <typename Q>
+    size_t operator()(const Prehashed<Q>& prehashed) const {
+        return prehashed.hash;
+    }
+};
+
+template <typename CharT, typename Traits, typename Alloc>
+struct TransparentHash<std::basic_string<CharT, Traits, Alloc>> {
+    using is_transparent = void;
+    using view_type = std::basic_string_view<CharT, Traits>;
+
+    size_t operator()(view_type key) const { return std::hash<view_type>{}(key); }
+
+    template <typename Q>
+    size_t operator()(const Prehashed<Q>& prehashed) const {
+        return prehashed.hash;
+    }
+};
+
+/**
+ * @brief Transparent equality that looks through Prehashed wrappers.
+ */
+struct TransparentEqual {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const {
+        return UnwrapKey(a) == UnwrapKey(b);
+    }
+};
+
+/**
+ * @brief True when both functors opt into heterogeneous lookup.
+ */
+template <typename Hash, typename KeyEqual>
+concept TransparentLookup = requires {
+    typename Hash::is_transparent;
+    typename KeyEqual::is_transparent;
+};
+
+} // namespace Collections
@@ -0,0 +1,226 @@
+/**
+ * @file btree_map_test.cpp
+ * @brief Checks BTreeMap against std::map for SIMD-searched and generic keys,
+ *        bulk loading, and copies.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -Isrc -Itests tests/btree_map_test.cpp -o btree_map_test
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "btree_map.hpp"
+#include "check.hpp"
+
+using Collections::BTreeMap;
+using Collections::Vector;
+
+namespace {
+
+template <typename K, typename V>
+void CheckSame(const BTreeMap<K, V>& tree, const std::map<K, V>& model) {
+    CHECK(tree.size() == model.size());
+    auto it = model.begin();
+    for (auto [key, value] : tree) {
+        CHECK(it != model.end() && key == it->first && value == it->second);
+        ++it;
+    }
+    CHECK(it == model.end());
+}
+
+/** @brief Random operations over `range` keys produced by `gen`. */
+template <typename K, typename Gen>
+void TestMatchesMap(Gen gen, int ops, unsigned range) {
+    BTreeMap<K, int> tree;
+    std::map<K, int> model;
+    std::mt19937 rng(7);
+    for (int op = 0; op < ops; ++op) {
+        K key = gen(rng() % range);
+        switch (rng() % 10) {
+        case 0:
+        case 1:
+        case 2:
+        case 3: {
+            auto [it, inserted] = tree.insert(key, op);
+            auto expected = model.insert({key, op});
+            CHECK(inserted == expected.second && it.value() == expected.first->second);
+            break;
+        }
+        case 4:
+            tree.insert_or_assign(key, op);
+            model[key] = op;
+            break;
+        case 5:
+        case 6:
+            CHECK(tree.erase(key) == model.erase(key));
+            break;
+        case 7:
+            tree[key] += 1;
+            model[key] += 1;
+            break;
+        case 8: {
+            auto it = tree.find(key);
+            auto expected = model.find(key);
+            CHECK((it == tree.end()) == (expected == model.end()));
+            if (expected != model.end()) CHECK(it.value() == expected->second);
+            break;
+        }
+        default: {
+            K high = gen(rng() % range);
+            auto expected = model.lower_bound(key);
+            size_t count = 0;
+            for (auto [k, v] : tree.range(key, high)) {
+                CHECK(expected != model.end() && k == expected->first && v == expected->second);
+                ++expected;
+                ++count;
+            }
+            if (key < high) CHECK(expected == model.lower_bound(high));
+            size_t scanned = 0;
+            tree.scan(key, high, [&](const K&, const int&) { ++scanned; });
+            CHECK(scanned == count);
+            auto upper = tree.upper_bound(key);
+            auto expected_upper = model.upper_bound(key);
+            CHECK((upper == tree.end()) == (expected_upper == model.end()));
+            if (expected_upper != model.end()) CHECK(upper.key() == expected_upper->first);
+            break;
+        }
+        }
+        CHECK(tree.size() == model.size());
+        if (op % 20000 == 0) {
+            BTreeMap<K, int> copy(tree);
+            CheckSame(copy, model);
+            tree = copy;
+            CheckSame(tree, model);
+        }
+    }
+    CheckSame(tree, model);
+
+    while (!model.empty()) {
+        CHECK(tree.erase(model.begin()->first) == 1);
+        model.erase(model.begin());
+    }
+    CHECK(tree.empty() && tree.height() == 0 && tree.begin() == tree.end());
+}
+
+/** @brief bulk_load() at sizes around full leaves and full inner nodes. */
+template <typename K, typename Gen>
+void TestBulkLoad(Gen gen) {
+    constexpr size_t kSlots = BTreeMap<K, int>::kSlots;
+    for (size_t n : {size_t{0}, size_t{1}, size_t{5}, kSlots, kSlots + 1, kSlots + 2, kSlots * (kSlots + 1),
+                     kSlots * (kSlots + 1) + 1, size_t{100000}}) {
+        std::map<K, int> model;
+        for (unsigned i = 0; model.size() < n; ++i) model[gen(i)] = static_cast<int>(i);
+        Vector<K> keys;
+        Vector<int> values;
+        for (const auto& [key, value] : model) {
+            keys.push_back(K(key));
+            values.push_back(int(value));
+        }
+        BTreeMap<K, int> tree(keys, values);
+        CheckSame(tree, model);
+        for (const auto& [key, value] : model) CHECK(tree.at(key) == value);
+
+        unsigned i = 0;
+        for (const auto& entry : model) {
+            if (i++ % 3 == 0) CHECK(tree.erase(entry.first) == 1);
+        }
+        for (const auto& [key, value] : model) tree.insert(key, value);
+        CheckSame(tree, model);
+    }
+}
+
+/** @brief Its copy throws once `copies_left` runs out. */
+struct FragileValue {
+    static inline int copies_left = -1;
+    int id = 0;
+
+    FragileValue() = default;
+    explicit FragileValue(int i) : id(i) {}
+    FragileValue(const FragileValue& other) = default;
+    FragileValue& operator=(const FragileValue& other) {
+        if (copies_left == 0) throw std::runtime_error("copy");
+        if (copies_left > 0) --copies_left;
+        id = other.id;
+        return *this;
+    }
+    FragileValue& operator=(FragileValue&&) = default;
+};
+
+void TestFailedCopy() {
+    BTreeMap<int, FragileValue> tree;
+    for (int i = 0; i < 5000; ++i) tree.insert(i, FragileValue(i));
+    BTreeMap<int, FragileValue> target;
+    target.insert(-1, FragileValue(-1));
+
+    FragileValue::copies_left = 3000;
+    bool threw = false;
+    try {
+        target = tree;
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    FragileValue::copies_left = -1;
+    CHECK(threw);  // LeakSanitizer checks the partial copy was freed
+    CHECK(target.size() == 1 && target.at(-1).id == -1);
+    CHECK(tree.size() == 5000);
+
+    target = tree;
+    CHECK(target.size() == 5000);
+    for (int i = 0; i < 5000; ++i) CHECK(target.at(i).id == i);
+}
+
+void TestErrors() {
+    BTreeMap<int, int> tree;
+    for (int i = 0; i < 100000; ++i) tree.insert(i, i);
+    CHECK(tree.height() == 3);  // ascending appends leave full leaves
+
+    bool threw = false;
+    try {
+        tree.bulk_load(Vector<int>{3, 2}, Vector<int>{1, 1});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw && tree.size() == 100000);
+    threw = false;
+    try {
+        tree.at(-1);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    BTreeMap<int, int> moved(std::move(tree));
+    CHECK(moved.size() == 100000 && tree.empty());
+    tree = std::move(moved);
+    CHECK(tree.size() == 100000);
+}
+
+} // namespace
+
+int main() {
+    // The node header shares the first cache line with the keys.
+    static_assert(BTreeMap<uint64_t, int>::kSlots == 31);
+    static_assert(BTreeMap<int32_t, int>::kSlots == 62);
+
+    TestMatchesMap<int>([](unsigned x) { return static_cast<int>(x) - 500; }, 200000, 3000);
+    TestMatchesMap<unsigned>([](unsigned x) { return x * 2654435761u; }, 200000, 3000);
+    TestMatchesMap<long long>([](unsigned x) { return x * 1000003LL - (1LL << 40); }, 200000, 3000);
+    TestMatchesMap<unsigned long long>([](unsigned x) { return static_cast<unsigned long long>(x) << 45; },
+                                       100000, 3000);
+    TestMatchesMap<double>([](unsigned x) { return x * 0.5 - 100; }, 100000, 3000);
+    TestMatchesMap<float>([](unsigned x) { return x * 0.25f - 10; }, 100000, 3000);
+    TestMatchesMap<std::string>([](unsigned x) { return std::to_string(x); }, 100000, 3000);
+
+    TestBulkLoad<int>([](unsigned x) { return static_cast<int>(x * 7); });
+    TestBulkLoad<std::string>([](unsigned x) { return std::to_string(x); });
+    TestFailedCopy();
+    TestErrors();
+    std::printf("btree_map_test: ok\n");
+    return 0;
+}
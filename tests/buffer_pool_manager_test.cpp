@@ -0,0 +1,229 @@
+/**
+ * @file buffer_pool_manager_test.cpp
+ * @brief Checks BufferPoolManager page-id validation, failing disk I/O and
+ *        concurrent fetches of the same pages.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -pthread -Isrc -Itests tests/buffer_pool_manager_test.cpp -o buffer_pool_manager_test
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "buffer_pool_manager.hpp"
+#include "check.hpp"
+
+using Collections::BufferPoolManager;
+using Collections::BufferPoolOptions;
+using Collections::DiskManager;
+using Collections::Page;
+using Collections::page_id_t;
+
+namespace {
+
+std::string PagePath() {
+    return (std::filesystem::temp_directory_path() / ("buffer_pool_manager_test_" + std::to_string(getpid())))
+        .string();
+}
+
+/**
+ * @brief A DiskManager whose descriptor can be pointed at a directory, so
+ *        every pread/pwrite fails until it is restored.
+ */
+class FaultyDisk {
+private:
+    int fd_;     ///< The descriptor number DiskManager opened.
+    int saved_;  ///< Duplicate of the page file while broken.
+
+public:
+    DiskManager disk;
+
+    explicit FaultyDisk(const std::string& path) : fd_(NextFd()), saved_(-1), disk(path) {
+        char link[256] = {};
+        CHECK(readlink(("/proc/self/fd/" + std::to_string(fd_)).c_str(), link, sizeof(link) - 1) > 0);
+        CHECK(std::filesystem::equivalent(link, path));
+    }
+
+    static int NextFd() {
+        int fd = open("/dev/null", O_RDONLY);
+        close(fd);
+        return fd;
+    }
+
+    void Break() {
+        saved_ = dup(fd_);
+        int dir = open(std::filesystem::temp_directory_path().c_str(), O_RDONLY | O_DIRECTORY);
+        CHECK(dup2(dir, fd_) == fd_);
+        close(dir);
+    }
+
+    void Repair() {
+        CHECK(dup2(saved_, fd_) == fd_);
+        close(saved_);
+    }
+};
+
+page_id_t NewFilledPage(BufferPoolManager& bpm, uint8_t fill) {
+    page_id_t id;
+    Page* page = bpm.NewPage(&id);
+    CHECK(page != nullptr);
+    std::memset(page->GetData(), fill, Collections::kPageSize);
+    CHECK(bpm.UnpinPage(id, true));
+    return id;
+}
+
+bool Holds(BufferPoolManager& bpm, page_id_t id, uint8_t fill) {
+    auto guard = bpm.FetchPageRead(id);
+    CHECK(guard);
+    for (size_t i = 0; i < Collections::kPageSize; ++i) {
+        if (static_cast<uint8_t>(guard.GetData()[i]) != fill) return false;
+    }
+    return true;
+}
+
+/** @brief Pins `count` distinct pages at once; fails if a frame went missing. */
+void CheckAllFramesUsable(BufferPoolManager& bpm, size_t count) {
+    std::vector<Page*> pinned;
+    for (page_id_t id = 0; id < static_cast<page_id_t>(count); ++id) {
+        Page* page = bpm.FetchPage(id);
+        CHECK(page != nullptr);
+        pinned.push_back(page);
+    }
+    for (Page* page : pinned) CHECK(bpm.UnpinPage(page->GetPageId(), false));
+}
+
+void TestInvalidPageIds(const std::string& path) {
+    DiskManager disk(path);
+    BufferPoolManager bpm(disk, BufferPoolOptions{.pool_size = 4});
+    for (int i = 0; i < 4; ++i) NewFilledPage(bpm, static_cast<uint8_t>(i));
+    for (page_id_t id : {page_id_t{-1}, page_id_t{-4096}, page_id_t{4}, page_id_t{1} << 40}) {
+        bool threw = false;
+        try {
+            bpm.FetchPage(id);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+    CheckAllFramesUsable(bpm, 4);
+}
+
+void TestFailingRead(const std::string& path) {
+    FaultyDisk faulty(path);
+    BufferPoolManager bpm(faulty.disk, BufferPoolOptions{.pool_size = 4});
+    for (int i = 0; i < 8; ++i) NewFilledPage(bpm, static_cast<uint8_t>(i + 1));
+    bpm.FlushAllPages();
+
+    // Pages 0..3 were evicted (clean now) by the later NewPage calls.
+    faulty.Break();
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        bool threw = false;
+        try {
+            bpm.FetchPage(attempt % 4);
+        } catch (const std::system_error&) {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+    faulty.Repair();
+
+    CheckAllFramesUsable(bpm, 4);  // no frame leaked by the failed reads
+    for (int i = 0; i < 8; ++i) CHECK(Holds(bpm, i, static_cast<uint8_t>(i + 1)));
+}
+
+void TestFailingWriteBack(const std::string& path) {
+    {
+        FaultyDisk faulty(path);
+        BufferPoolManager bpm(faulty.disk, BufferPoolOptions{.pool_size = 2});
+        for (int i = 0; i < 4; ++i) NewFilledPage(bpm, 0x10);
+        bpm.FlushAllPages();
+        for (int i = 0; i < 2; ++i) {
+            auto guard = bpm.FetchPageWrite(i);
+            std::memset(guard.GetDataMut(), 0x20 + i, Collections::kPageSize);
+        }
+
+        faulty.Break();
+        bool threw = false;
+        try {
+            bpm.FetchPage(3);  // needs a frame: the dirty victim cannot be written
+        } catch (const std::system_error&) {
+            threw = true;
+        }
+        CHECK(threw);
+        threw = false;
+        try {
+            bpm.FlushPage(0);
+        } catch (const std::system_error&) {
+            threw = true;
+        }
+        CHECK(threw);
+        faulty.Repair();
+
+        // Both modified pages are still resident and dirty.
+        CHECK(Holds(bpm, 0, 0x20));
+        CHECK(Holds(bpm, 1, 0x21));
+        CHECK(Holds(bpm, 3, 0x10));
+        bpm.FlushAllPages();
+    }
+    DiskManager disk(path);
+    BufferPoolManager bpm(disk, BufferPoolOptions{.pool_size = 2});
+    CHECK(Holds(bpm, 0, 0x20));
+    CHECK(Holds(bpm, 1, 0x21));
+}
+
+/** @brief Threads increment per-page counters through a pool smaller than the page set. */
+void TestConcurrentFetches(const std::string& path) {
+    constexpr int kPages = 16;
+    constexpr int kThreads = 4;
+    constexpr int kRounds = 2000;
+    {
+        DiskManager disk(path);
+        BufferPoolManager bpm(disk, BufferPoolOptions{.pool_size = 6});
+        for (int i = 0; i < kPages; ++i) NewFilledPage(bpm, 0);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&bpm, t] {
+                for (int r = 0; r < kRounds; ++r) {
+                    page_id_t id = (r * 7 + t) % kPages;
+                    auto guard = bpm.FetchPageWrite(id);
+                    CHECK(guard);
+                    ++*guard.AsMut<uint64_t>();
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+    }
+    DiskManager disk(path);
+    BufferPoolManager bpm(disk, BufferPoolOptions{.pool_size = 6});
+    uint64_t total = 0;
+    for (int i = 0; i < kPages; ++i) total += *bpm.FetchPageRead(i).As<uint64_t>();
+    CHECK(total == uint64_t{kThreads} * kRounds);
+}
+
+} // namespace
+
+int main() {
+    std::string path = PagePath();
+    std::filesystem::remove(path);
+    TestInvalidPageIds(path);
+    std::filesystem::remove(path);
+    TestFailingRead(path);
+    std::filesystem::remove(path);
+    TestFailingWriteBack(path);
+    std::filesystem::remove(path);
+    TestConcurrentFetches(path);
+    std::filesystem::remove(path);
+    std::printf("buffer_pool_manager_test: ok\n");
+    return 0;
+}
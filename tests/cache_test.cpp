@@ -0,0 +1,271 @@
+/**
+ * @file cache_test.cpp
+ * @brief Checks the Cache front-end against LRUCache and LRU_K_Cache, SLRU's
+ *        segments and scan resistance, its exception paths, and
+ *        NegativeCache on top of it.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -Isrc -Itests tests/cache_test.cpp -o cache_test
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bloom_filter.hpp"
+#include "cache.hpp"
+#include "check.hpp"
+#include "lru_cache.hpp"
+#include "lru_k_replacer.hpp"
+#include "negative_cache.hpp"
+
+using Collections::AccessType;
+using Collections::BloomFilter;
+using Collections::Cache;
+using Collections::ClockPolicy;
+using Collections::LookupState;
+using Collections::LRUCache;
+using Collections::LRUPolicy;
+using Collections::LRU_K_Cache;
+using Collections::LRUKPolicy;
+using Collections::NegativeCache;
+using Collections::SLRUPolicy;
+
+namespace {
+
+/** @brief Cache<LRUPolicy> must evict exactly what LRUCache evicts. */
+void TestMatchesLRUCache() {
+    Cache<uint64_t, uint64_t, LRUPolicy> cache(100);
+    LRUCache<uint64_t, uint64_t> model(100);
+    std::vector<uint64_t> evicted, model_evicted;
+    cache.set_eviction_listener([&](uint64_t&& key, uint64_t&&) { evicted.push_back(key); });
+    model.set_eviction_listener([&](uint64_t&& key, uint64_t&&, bool) { model_evicted.push_back(key); });
+
+    std::mt19937 rng(7);
+    for (int op = 0; op < 100000; ++op) {
+        uint64_t key = rng() % 300;
+        switch (rng() % 4) {
+        case 0:
+            CHECK(cache.erase(key) == model.erase(key));
+            break;
+        case 1:
+            CHECK(cache.get(key) == model.get(key));
+            break;
+        default:
+            cache.put(key, op);
+            model.put(key, op);
+            break;
+        }
+        CHECK(cache.size() == model.size());
+    }
+    CHECK(evicted == model_evicted);
+}
+
+/**
+ * @brief Cache<LRUKPolicy<2>> must evict exactly what LRU_K_Cache<2> evicts,
+ *        with hints, retained history and a correlated reference period.
+ */
+void TestMatchesLRUKCache() {
+    LRUKPolicy<2> policy;
+    policy.retained_history = 50;
+    policy.retained_period = 400;
+    policy.correlated_period = 3;
+    Cache<int, int, LRUKPolicy<2>, Collections::FlatIndex> cache(64, policy);
+    LRU_K_Cache<int, int, 2> model(64);
+    model.set_retained_history(50, 400);
+    model.set_correlated_reference_period(3);
+    std::vector<int> evicted;
+    cache.set_eviction_listener([&](int&& key, int&&) { evicted.push_back(key); });
+
+    constexpr AccessType kTypes[] = {AccessType::kUnknown, AccessType::kLookup, AccessType::kScan,
+                                     AccessType::kIndex, AccessType::kPrefetch};
+    std::mt19937 rng(11);
+    for (int op = 0; op < 100000; ++op) {
+        int key = static_cast<int>(rng() % 200);
+        AccessType type = rng() % 2 == 0 ? AccessType::kUnknown : kTypes[rng() % 5];
+        switch (rng() % 8) {
+        case 0:
+            CHECK(cache.erase(key) == model.Remove(key));
+            break;
+        case 1:
+        case 2:
+        case 3: {
+            bool full = cache.size() == 64 && !cache.contains(key);
+            evicted.clear();
+            cache.put(key, op, type);
+            model.Put(int(key), int(op), type);
+            if (full) CHECK(evicted.size() == 1 && !model.contains(evicted[0]));
+            break;
+        }
+        default:
+            CHECK(cache.get(key, type) == model.Get(key, type));
+            break;
+        }
+        CHECK(cache.size() == model.size());
+    }
+    for (int key = 0; key < 200; ++key) CHECK(cache.contains(key) == model.contains(key));
+}
+
+/** @brief A key whose move constructor throws once `moves_left` runs out. */
+struct FragileKey {
+    static inline int moves_left = -1;
+    int id;
+
+    explicit FragileKey(int i) : id(i) {}
+    FragileKey(const FragileKey&) = default;
+    FragileKey(FragileKey&& other) : id(other.id) {
+        if (moves_left == 0) throw std::runtime_error("move");
+        if (moves_left > 0) --moves_left;
+    }
+    FragileKey& operator=(const FragileKey&) = default;
+    bool operator==(const FragileKey& other) const { return id == other.id; }
+};
+
+struct FragileHash {
+    size_t operator()(const FragileKey& key) const { return std::hash<int>()(key.id); }
+};
+
+/** @brief A throwing index insert must not leak the new entry. */
+void TestThrowingInsert() {
+    Cache<FragileKey, std::vector<int>, LRUPolicy, Collections::UnorderedIndex, Collections::NoStats,
+          Collections::NullLock, FragileHash>
+        cache(4);
+    cache.put(FragileKey(1), {1});
+    FragileKey::moves_left = 1;  // the entry's own key moves, the index's key throws
+    bool threw = false;
+    try {
+        cache.put(FragileKey(2), std::vector<int>(100, 2));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    FragileKey::moves_left = -1;
+    CHECK(threw);
+    CHECK(cache.size() == 1);  // LeakSanitizer checks the entry was freed
+    CHECK(!cache.contains(FragileKey(2)));
+}
+
+/** @brief A throwing eviction listener drops the victim but keeps the new entry. */
+void TestThrowingListener() {
+    Cache<int, int, ClockPolicy> cache(2);
+    cache.set_eviction_listener([](int&&, int&&) { throw std::runtime_error("listener"); });
+    cache.put(1, 1);
+    cache.put(2, 2);
+    bool threw = false;
+    try {
+        cache.put(3, 3);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(cache.size() == 2);
+    CHECK(cache.get(3) == 3);
+}
+
+/** @brief An effectively unbounded capacity allocates nothing up front. */
+void TestHugeCapacity() {
+    Cache<int, int, LRUPolicy, Collections::FlatIndex> cache(size_t{1} << 60);
+    for (int i = 0; i < 1000; ++i) cache.put(i, i);
+    CHECK(cache.size() == 1000 && cache.get(0) == 0);
+}
+
+/** @brief A probationary hit is protected; protected overflow is demoted, not evicted. */
+void TestSLRUSegments() {
+    SLRUPolicy policy;
+    policy.protected_ratio = 0.5;
+    Cache<int, int, SLRUPolicy> cache(10, policy);  // 5 protected places
+    for (int i = 0; i < 10; ++i) cache.put(i, i);
+    CHECK(cache.get(0) == 0);  // promoted
+    cache.put(10, 10);         // evicts the oldest probationary entry, 1
+    CHECK(cache.contains(0) && !cache.contains(1));
+
+    for (int i = 2; i <= 6; ++i) CHECK(cache.get(i) == i);  // 6 protected: 0 is demoted
+    for (int i = 11; i <= 14; ++i) cache.put(i, i);           // evicts 7 to 10, older probationers
+    CHECK(cache.contains(0));
+    for (int i = 7; i <= 10; ++i) CHECK(!cache.contains(i));
+    cache.put(15, 15);
+    CHECK(!cache.contains(0));
+    for (int i = 2; i <= 6; ++i) CHECK(cache.contains(i));
+
+    policy.protected_ratio = 1.5;
+    bool threw = false;
+    try {
+        Cache<int, int, SLRUPolicy> bad(10, policy);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+/** @brief A one-pass scan flushes LRU but not SLRU's protected working set. */
+void TestSLRUScanResistance() {
+    Cache<int, int, SLRUPolicy> slru(100);
+    Cache<int, int, LRUPolicy> lru(100);
+    for (int i = 0; i < 50; ++i) {
+        slru.put(i, i);
+        lru.put(i, i);
+        CHECK(slru.get(i) == i && lru.get(i) == i);
+    }
+    for (int i = 1000; i < 2000; ++i) {
+        slru.put(i, i);
+        lru.put(i, i);
+    }
+    for (int i = 0; i < 50; ++i) {
+        CHECK(slru.contains(i));
+        CHECK(!lru.contains(i));
+    }
+}
+
+void TestNegativeCachePolicy() {
+    Collections::NegativeCacheOptions options;
+    options.capacity = 8;
+    options.negative_share = 0.5;
+    NegativeCache<int, int, std::hash<int>, ClockPolicy> cache(options);
+    for (int i = 0; i < 10; ++i) cache.put(i, i);
+    for (int i = 10; i < 20; ++i) cache.put_absent(i);
+    CHECK(cache.positive_size() == 4);
+    CHECK(cache.negative_size() == 4);
+    CHECK(cache.get(19).state == LookupState::kAbsent);
+    cache.put(19, 19);
+    CHECK(cache.get(19).state == LookupState::kHit);
+    CHECK(cache.negative_size() == 3);
+}
+
+/** @brief A key created behind the cache's back is reported once the owner says so. */
+void TestNegativeCacheKeyFilter() {
+    NegativeCache<int, int> cache;
+    BloomFilter<int> filter(1000, 0.001);
+    for (int i = 0; i < 100; ++i) filter.insert(i);
+    cache.set_key_filter(std::move(filter));
+
+    CHECK(cache.get(500).state == LookupState::kAbsent);
+    CHECK(cache.get(501).state == LookupState::kAbsent);
+    cache.add_key(500);  // another writer created it
+    CHECK(cache.get(500).state == LookupState::kMiss);
+    CHECK(!cache.erase(501));  // an invalidation also reopens the key
+    CHECK(cache.get(501).state == LookupState::kMiss);
+
+    cache.put_absent(502);
+    cache.add_key(502);  // drops the negative entry too
+    CHECK(cache.get(502).state == LookupState::kMiss && cache.negative_size() == 0);
+    CHECK(cache.get(503).state == LookupState::kAbsent);
+}
+
+} // namespace
+
+int main() {
+    TestMatchesLRUCache();
+    TestThrowingInsert();
+    TestThrowingListener();
+    TestHugeCapacity();
+    TestMatchesLRUKCache();
+    TestSLRUSegments();
+    TestSLRUScanResistance();
+    TestNegativeCachePolicy();
+    TestNegativeCacheKeyFilter();
+    std::printf("cache_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * @file check.hpp
+ * @brief Minimal assertion macro for the standalone test programs.
+ *
+ * Unlike assert(), CHECK stays active in optimized builds, so the tests can
+ * run under -O2 and the sanitizers alike.
+ */
+
+#define CHECK(condition)                                                             \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            std::exit(1);                                                            \
+        }                                                                            \
+    } while (false)
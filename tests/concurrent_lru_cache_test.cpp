@@ -0,0 +1,184 @@
+/**
+ * @file concurrent_lru_cache_test.cpp
+ * @brief Checks ConcurrentLRUCache recency order, the lossy read buffer,
+ *        epoch reclamation and a multi-threaded put/get/erase stress.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -pthread -Isrc -Itests tests/concurrent_lru_cache_test.cpp -o concurrent_lru_cache_test
+ *
+ * Also run it under -fsanitize=thread.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+#include "concurrent_lru_cache.hpp"
+#include "epoch_reclamation.hpp"
+
+using Collections::ConcurrentLRUCache;
+using Collections::EpochDomain;
+
+namespace {
+
+/** @brief A value derived from its key, counted while alive, so a torn or freed read shows. */
+struct Payload {
+    static inline std::atomic<int64_t> live{0};
+
+    uint64_t key;
+    uint64_t version;
+    uint64_t check;
+
+    Payload(uint64_t k, uint64_t v) : key(k), version(v), check(k * 0x9E3779B97F4A7C15ULL ^ v) { ++live; }
+    Payload(const Payload& other) : key(other.key), version(other.version), check(other.check) { ++live; }
+    ~Payload() { --live; }
+
+    bool Valid(uint64_t expected_key) const {
+        return key == expected_key && check == (key * 0x9E3779B97F4A7C15ULL ^ version);
+    }
+};
+
+using Cache = ConcurrentLRUCache<uint64_t, Payload>;
+
+/** @brief Reads are buffered and replayed at the next write; eviction follows them. */
+void TestRecencyOrder() {
+    Cache cache(4, 1);
+    for (uint64_t k = 1; k <= 4; ++k) cache.put(k, Payload(k, 0));
+    CHECK(cache.get(1)->Valid(1));
+    cache.put(5, Payload(5, 0));  // 2 is now the least recently used
+    CHECK(cache.contains(1) && !cache.contains(2));
+
+    cache.put(3, Payload(3, 1));  // a replacement counts as a use
+    cache.put(6, Payload(6, 0));
+    CHECK(!cache.contains(4) && cache.contains(3));
+    CHECK(cache.get(3)->version == 1);
+
+    CHECK(!cache.contains(2));  // contains() is not an access
+    cache.put(7, Payload(7, 0));
+    CHECK(!cache.contains(1));
+    CHECK(cache.erase(5));
+    CHECK(!cache.erase(5));
+    CHECK(cache.size() == 3);
+}
+
+/**
+ * @brief A key whose comparison can be made to block, so a test can hold the
+ *        writer lock inside put() while other threads read.
+ */
+struct GateKey {
+    static inline std::atomic<bool> armed{false};
+    static inline std::atomic<bool> entered{false};
+    static inline std::atomic<bool> released{false};
+    static constexpr uint64_t kGate = 4;
+
+    uint64_t id;
+
+    bool operator==(const GateKey& other) const {
+        if (id == kGate && other.id == kGate && armed.exchange(false)) {
+            entered = true;
+            while (!released) std::this_thread::yield();
+        }
+        return id == other.id;
+    }
+};
+
+struct GateKeyHash {
+    size_t operator()(const GateKey& key) const { return key.id; }
+};
+
+/** @brief Reads past a full buffer are dropped while the writer lock is busy. */
+void TestLossyReadBuffer() {
+    ConcurrentLRUCache<GateKey, int, GateKeyHash> cache(4, 1);
+    for (uint64_t k = 1; k <= 4; ++k) cache.put(GateKey{k}, 0);  // 4 is the gate key
+
+    GateKey::armed = true;
+    std::thread writer([&cache] { cache.put(GateKey{GateKey::kGate}, 1); });
+    while (!GateKey::entered) std::this_thread::yield();
+    for (int i = 0; i < 32; ++i) CHECK(cache.get(GateKey{2}) == 0);  // fills the one stripe
+    CHECK(cache.get(GateKey{1}) == 0);  // still a hit, but the access is dropped
+    GateKey::released = true;
+    writer.join();
+
+    cache.put(GateKey{5}, 0);  // replays 2's reads; 1 never moved, so it goes
+    CHECK(!cache.contains(GateKey{1}));
+    CHECK(cache.contains(GateKey{2}) && cache.contains(GateKey{3}));
+    CHECK(cache.get(GateKey{GateKey::kGate}) == 1);
+}
+
+/** @brief An entry retired while a reader is pinned outlives the pin, then is freed. */
+void TestEpochReclamation() {
+    Cache cache(8, 1);
+    for (uint64_t k = 0; k < 8; ++k) cache.put(k, Payload(k, 0));
+    cache.maintenance();
+    CHECK(Payload::live == 8);
+    {
+        auto guard = EpochDomain::Global().Pin();
+        CHECK(cache.erase(0));
+        cache.put(1, Payload(1, 1));
+        cache.maintenance();
+        CHECK(Payload::live == 9);  // both retired entries are still reachable by the reader
+    }
+    cache.maintenance();
+    CHECK(Payload::live == 7);
+}
+
+/** @brief Threads mix reads and writes; every read must see an intact value of its key. */
+void TestConcurrentStress() {
+    constexpr int kThreads = 6;
+    constexpr int kOps = 200000;
+    constexpr uint64_t kKeys = 512;
+    constexpr size_t kCapacity = 128;
+    {
+        Cache cache(kCapacity);
+        std::atomic<uint64_t> hits{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&cache, &hits, t] {
+                std::mt19937_64 rng(t);
+                for (int op = 0; op < kOps; ++op) {
+                    uint64_t key = rng() % kKeys;
+                    switch (rng() % 8) {
+                    case 0:
+                        cache.put(key, Payload(key, rng()));
+                        break;
+                    case 1:
+                        cache.erase(key);
+                        break;
+                    default:
+                        if (std::optional<Payload> value = cache.get(key)) {
+                            CHECK(value->Valid(key));
+                            hits.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        break;
+                    }
+                    CHECK(cache.size() <= kCapacity);
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        CHECK(hits > 0);
+
+        cache.maintenance();
+        CHECK(static_cast<size_t>(Payload::live.load()) == cache.size());
+        for (uint64_t key = 0; key < kKeys; ++key) {
+            if (std::optional<Payload> value = cache.get(key)) CHECK(value->Valid(key));
+        }
+    }
+    CHECK(Payload::live == 0);
+}
+
+} // namespace
+
+int main() {
+    TestRecencyOrder();
+    TestLossyReadBuffer();
+    TestEpochReclamation();
+    TestConcurrentStress();
+    std::printf("concurrent_lru_cache_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file fixed_lru_test.cpp
+ * @brief Compares FixedLRU with LRUCache under random operations.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -Isrc -Itests tests/fixed_lru_test.cpp -o fixed_lru_test
+ */
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+#include "check.hpp"
+#include "fixed_lru.hpp"
+#include "lru_cache.hpp"
+
+using Collections::FixedLRU;
+using Collections::LRUCache;
+
+namespace {
+
+/** @brief Random get/put/erase against LRUCache; `stride` spaces the keys out. */
+template <typename Cache>
+void Compare(Cache& cache, size_t capacity, uint64_t universe, uint64_t stride, uint32_t seed) {
+    LRUCache<uint64_t, uint64_t> model(static_cast<int>(capacity));
+    std::mt19937 rng(seed);
+    for (int op = 0; op < 300000; ++op) {
+        uint64_t key = (rng() % universe) * stride;
+        uint64_t value = rng();
+        switch (rng() % 8) {
+            case 0:
+                CHECK(cache.erase(key) == model.erase(key));
+                break;
+            case 1:
+            case 2:
+            case 3:
+                cache.put(key, value);
+                model.put(key, value);
+                break;
+            default:
+                CHECK(cache.get(key) == model.get(key));
+        }
+        CHECK(cache.size() == model.size());
+    }
+    for (uint64_t k = 0; k < universe; ++k) CHECK(cache.contains(k * stride) == model.contains(k * stride));
+}
+
+} // namespace
+
+int main() {
+    for (uint64_t stride : {uint64_t{1}, uint64_t{1} << 16, uint64_t{1} << 40}) {
+        FixedLRU<uint64_t, uint64_t> dynamic(1000);
+        Compare(dynamic, 1000, 1500, stride, 1);
+        FixedLRU<uint64_t, uint64_t, 64> inline_storage;
+        Compare(inline_storage, 64, 100, stride, 2);
+    }
+
+    bool threw = false;
+    try {
+        FixedLRU<int, int> too_large(size_t{1} << 40);  // rejected before allocating
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    std::printf("fixed_lru_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file flat_hash_map_test.cpp
+ * @brief Checks FlatHashMap against std::unordered_map, a failing rehash
+ *        and copy, and that moved entries do not copy their keys.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -Isrc -Itests tests/flat_hash_map_test.cpp -o flat_hash_map_test
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "check.hpp"
+#include "flat_hash_map.hpp"
+
+using Collections::FlatHashMap;
+
+namespace {
+
+/** @brief Collides heavily, so clusters are long and erase shifts a lot. */
+struct CoarseHash {
+    size_t operator()(uint64_t key) const { return key / 8; }
+};
+
+template <typename Map, typename Model>
+void CheckSame(const Map& map, const Model& model) {
+    CHECK(map.size() == model.size());
+    size_t visited = 0;
+    for (const auto& [key, value] : map) {
+        auto it = model.find(key);
+        CHECK(it != model.end() && it->second == value);
+        ++visited;
+    }
+    CHECK(visited == model.size());
+}
+
+template <typename Hash>
+void TestMatchesUnorderedMap(uint32_t seed) {
+    FlatHashMap<uint64_t, std::string, Hash> map;
+    std::unordered_map<uint64_t, std::string> model;
+    std::mt19937 rng(seed);
+    for (int op = 0; op < 200000; ++op) {
+        uint64_t key = rng() % 1000;
+        std::string value = std::to_string(op);
+        switch (rng() % 10) {
+        case 0:
+        case 1:
+            CHECK(map.erase(key) == model.erase(key));
+            break;
+        case 2: {
+            bool inserted = map.try_emplace(key, value).second;
+            CHECK(inserted == model.try_emplace(key, value).second);
+            break;
+        }
+        case 3:
+            map[key] = value;
+            model[key] = value;
+            break;
+        case 4: {
+            auto it = map.find(key);
+            if (it != map.end()) {
+                map.erase(it);
+                model.erase(key);
+            }
+            break;
+        }
+        case 5:
+            if (rng() % 1000 == 0) {
+                uint64_t modulus = 2 + rng() % 5;
+                auto odd = [modulus](const auto& entry) { return entry.first % modulus == 1; };
+                CHECK(map.erase_if(odd) == std::erase_if(model, odd));
+            } else if (rng() % 1000 == 1) {
+                map.rehash(rng() % 4096);
+            } else if (rng() % 1000 == 2) {
+                FlatHashMap<uint64_t, std::string, Hash> copy(map);
+                CheckSame(copy, model);
+                map = std::move(copy);
+            }
+            break;
+        default: {
+            auto it = map.find(key);
+            auto expected = model.find(key);
+            CHECK((it == map.end()) == (expected == model.end()));
+            if (it != map.end()) CHECK(it->second == expected->second);
+            break;
+        }
+        }
+        CHECK(map.size() == model.size());
+        CHECK(map.load_factor() <= map.max_load_factor());
+    }
+    CheckSame(map, model);
+    map.clear();
+    CHECK(map.empty() && map.begin() == map.end());
+}
+
+/** @brief Its copy throws once `copies_left` runs out; its move may throw, so a rehash copies. */
+struct FragileValue {
+    static inline int copies_left = -1;
+    int id;
+
+    explicit FragileValue(int i) : id(i) {}
+    FragileValue(const FragileValue& other) : id(other.id) {
+        if (copies_left == 0) throw std::runtime_error("copy");
+        if (copies_left > 0) --copies_left;
+    }
+    FragileValue(FragileValue&& other) : FragileValue(std::as_const(other)) {}
+};
+
+void TestFailedRehash() {
+    FlatHashMap<int, FragileValue> map;
+    int count = 0;
+    while (map.size() + 1 <= map.bucket_count() * 7 / 8 || map.size() < 100) {
+        map.try_emplace(count, count);
+        ++count;
+    }
+    size_t capacity = map.bucket_count();
+    FragileValue::copies_left = count / 2;  // fails halfway through moving to the new table
+    bool threw = false;
+    try {
+        map.try_emplace(count, count);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    FragileValue::copies_left = -1;
+    CHECK(threw);
+    CHECK(map.bucket_count() == capacity);  // LeakSanitizer checks the new table was freed
+    CHECK(map.size() == static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) CHECK(map.at(i).id == i);
+    map.try_emplace(count, count);
+    CHECK(map.bucket_count() == 2 * capacity && map.at(count).id == count);
+}
+
+void TestFailedCopy() {
+    FlatHashMap<int, FragileValue> map;
+    for (int i = 0; i < 1000; ++i) map.try_emplace(i, i);
+    FlatHashMap<int, FragileValue> target;
+    target.try_emplace(-1, -1);
+
+    FragileValue::copies_left = 500;  // fails halfway through the copy
+    bool threw = false;
+    try {
+        target = map;
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    FragileValue::copies_left = -1;
+    CHECK(threw);  // LeakSanitizer checks the partial copy was freed
+    CHECK(target.size() == 1 && target.at(-1).id == -1);
+
+    FlatHashMap<int, FragileValue> copy(map);
+    CHECK(copy.size() == 1000);
+    for (int i = 0; i < 1000; ++i) CHECK(copy.at(i).id == i);
+}
+
+/** @brief Counts its copies; moves are free. */
+struct CountedKey {
+    static inline int copies = 0;
+    uint64_t id;
+
+    explicit CountedKey(uint64_t i) : id(i) {}
+    CountedKey(const CountedKey& other) : id(other.id) { ++copies; }
+    CountedKey(CountedKey&& other) noexcept = default;
+    bool operator==(const CountedKey& other) const { return id == other.id; }
+};
+
+struct CountedKeyHash {
+    size_t operator()(const CountedKey& key) const { return key.id / 4; }
+};
+
+void TestKeysAreMoved() {
+    FlatHashMap<CountedKey, int, CountedKeyHash> map;
+    for (uint64_t i = 0; i < 5000; ++i) {
+        map.emplace(CountedKey(i), 0);
+        map.try_emplace(CountedKey(i + 100000), 0);
+    }
+    for (uint64_t i = 0; i < 5000; i += 2) CHECK(map.erase(CountedKey(i)) == 1);
+    map.rehash(0);
+    CHECK(CountedKey::copies == 0);
+    CHECK(map.size() == 7500);
+}
+
+} // namespace
+
+int main() {
+    TestMatchesUnorderedMap<std::hash<uint64_t>>(1);
+    TestMatchesUnorderedMap<CoarseHash>(2);
+    TestFailedRehash();
+    TestFailedCopy();
+    TestKeysAreMoved();
+    std::printf("flat_hash_map_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file lru_cache_snapshot_test.cpp
+ * @brief Round-trips LRUCache snapshots, including incremental snapshots
+ *        taken while the cache is in use.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -Isrc -Itests tests/lru_cache_snapshot_test.cpp -o lru_cache_snapshot_test
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <string>
+
+#include "check.hpp"
+#include "lru_cache.hpp"
+
+using Collections::LRUCache;
+using Collections::SnapshotStatus;
+
+namespace {
+
+const std::string kPath = "lru_cache_snapshot_test.snap";
+
+/** @brief Loads a snapshot into an empty cache and returns its keys, checking for duplicates. */
+std::set<int> LoadKeys(size_t expected) {
+    LRUCache<int, std::string> restored(1 << 20);
+    CHECK(restored.load_snapshot(kPath));
+    CHECK(restored.size() == expected);
+    std::set<int> keys;
+    for (int key = -1000; key < 100000; ++key) {
+        if (restored.contains(key)) {
+            keys.insert(key);
+            CHECK(restored.get(key) == std::to_string(key));
+        }
+    }
+    return keys;
+}
+
+void TestFullRoundTrip() {
+    LRUCache<int, std::string> cache(100);
+    for (int i = 0; i < 100; ++i) cache.put(i, std::to_string(i));
+    CHECK(cache.save_snapshot(kPath));
+
+    LRUCache<int, std::string> restored(10);  // keeps the 10 most recent
+    CHECK(restored.load_snapshot(kPath));
+    CHECK(restored.size() == 10);
+    for (int i = 90; i < 100; ++i) CHECK(restored.contains(i));
+}
+
+void TestPromotionDuringIncrementalSnapshot() {
+    LRUCache<int, std::string> cache(2000);  // room for the insertion, so nothing is evicted
+    for (int i = 0; i < 1000; ++i) cache.put(i, std::to_string(i));
+
+    CHECK(cache.begin_snapshot(kPath));
+    CHECK(cache.snapshot_step(100) == SnapshotStatus::kInProgress);  // wrote 999..900
+    for (int i = 0; i < 50; ++i) CHECK(cache.get(i).has_value());    // not reached yet
+    for (int i = 950; i < 960; ++i) CHECK(cache.get(i).has_value()); // already written
+    cache.put(-1, "-1");                                             // inserted mid-walk
+    CHECK(cache.snapshot_step(300) == SnapshotStatus::kInProgress);
+    cache.put(500, "500");  // promoted while at the cursor's neighbourhood
+    while (cache.snapshot_step(64) == SnapshotStatus::kInProgress) cache.get(0);
+
+    std::set<int> keys = LoadKeys(1001);
+    CHECK(keys.size() == 1001);
+    for (int i = -1; i < 1000; ++i) CHECK(keys.count(i) == 1);
+}
+
+void TestCorruptSnapshotRejected() {
+    LRUCache<int, std::string> cache(10);
+    for (int i = 0; i < 10; ++i) cache.put(i, std::to_string(i));
+    CHECK(cache.save_snapshot(kPath));
+    {
+        std::fstream file(kPath, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put('x');
+    }
+    LRUCache<int, std::string> restored(10);
+    CHECK(!restored.load_snapshot(kPath));
+    CHECK(restored.size() == 0);
+}
+
+} // namespace
+
+int main() {
+    TestFullRoundTrip();
+    TestPromotionDuringIncrementalSnapshot();
+    TestCorruptSnapshotRejected();
+    std::remove(kPath.c_str());
+    std::printf("lru_cache_snapshot_test: ok\n");
+    return 0;
+}
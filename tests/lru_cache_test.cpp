@@ -0,0 +1,282 @@
+/**
+ * @file lru_cache_test.cpp
+ * @brief Checks LRUCache heterogeneous and prehashed lookup, listeners,
+ *        dirty write-back and incremental shrinking.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -Isrc -Itests tests/lru_cache_test.cpp -o lru_cache_test
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+#include "lru_cache.hpp"
+#include "transparent_hash.hpp"
+
+using Collections::LRUCache;
+using Collections::Prehashed;
+using Collections::TransparentEqual;
+using Collections::TransparentHash;
+
+namespace {
+
+/** @brief Counts every allocation made for the strings that use it. */
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+    static inline size_t allocations = 0;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        ++allocations;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+};
+
+using String = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+/** @brief TransparentHash that counts the keys it hashes itself. */
+struct CountingHash : TransparentHash<String> {
+    static inline size_t hashed = 0;
+
+    size_t operator()(std::string_view key) const {
+        ++hashed;
+        return TransparentHash<String>::operator()(key);
+    }
+    using TransparentHash<String>::operator();
+};
+
+using StringCache = LRUCache<String, int, CountingHash, TransparentEqual>;
+
+/** @brief Longer than the small-string buffer, so every String allocates. */
+std::string KeyText(int i) { return "a key long enough to need the heap #" + std::to_string(i); }
+
+void TestStringViewLookup() {
+    StringCache cache(8);
+    for (int i = 0; i < 8; ++i) cache.put(String(KeyText(i)), i);
+
+    std::string texts[8];
+    for (int i = 0; i < 8; ++i) texts[i] = KeyText(i);
+    std::string missing = KeyText(100);
+
+    size_t allocations = CountingAllocator<char>::allocations;
+    for (int i = 0; i < 8; ++i) {
+        std::string_view view = texts[i];
+        CHECK(cache.get(view) == i);
+        CHECK(cache.contains(view));
+        CHECK(cache.get(texts[i].c_str()) == i);
+    }
+    CHECK(!cache.get(std::string_view(missing)).has_value());
+    CHECK(!cache.contains(std::string_view(missing)));
+    CHECK(cache.erase(std::string_view(texts[3])));
+    CHECK(!cache.erase(std::string_view(texts[3])));
+    CHECK(CountingAllocator<char>::allocations == allocations);  // no String was built
+    CHECK(cache.size() == 7);
+
+    // A string_view lookup promotes like a String one: 0 is now the newest.
+    CHECK(cache.get(std::string_view(texts[0])) == 0);
+    cache.put(String(KeyText(8)), 8);
+    cache.put(String(KeyText(9)), 9);
+    CHECK(cache.contains(std::string_view(texts[0])));
+    CHECK(!cache.contains(std::string_view(texts[1])));
+}
+
+void TestPrehashedLookup() {
+    StringCache cache(4);
+    std::string text = KeyText(1);
+    cache.put(String(text), 1);
+    size_t hash = cache.hash_function()(std::string_view(text));
+
+    size_t hashed = CountingHash::hashed;
+    size_t allocations = CountingAllocator<char>::allocations;
+    std::string_view view = text;
+    CHECK(cache.get(Prehashed{view, hash}) == 1);
+    CHECK(cache.contains(Prehashed{view, hash}));
+    CHECK(CountingHash::hashed == hashed);  // the carried hash was used as is
+    CHECK(CountingAllocator<char>::allocations == allocations);
+
+    // The key is still compared: a matching hash with another key misses.
+    std::string other = KeyText(2);
+    CHECK(!cache.contains(Prehashed{std::string_view(other), hash}));
+    CHECK(cache.erase(Prehashed{view, hash}));
+    CHECK(cache.size() == 0);
+}
+
+/** @brief One listener call: which listener, the key and the dirty bit. */
+struct Event {
+    char listener;
+    int key;
+    bool dirty;
+
+    bool operator==(const Event&) const = default;
+};
+
+void TestListeners() {
+    LRUCache<int, int> cache(2);
+    std::vector<Event> events;
+    cache.set_eviction_listener([&](int&& key, int&& value, bool dirty) {
+        CHECK(value == key * 10);
+        events.push_back({'e', key, dirty});
+    });
+    cache.set_removal_listener([&](int&& key, int&&, bool dirty) { events.push_back({'r', key, dirty}); });
+
+    cache.put(1, 10, true);
+    cache.put(2, 20);
+    cache.put(2, 20);  // an update evicts nothing
+    CHECK(events.empty());
+    cache.put(3, 30);  // evicts 1, still dirty
+    CHECK(cache.erase(2));
+    CHECK(!cache.erase(2));
+    CHECK(cache.take(3) == 30);  // take() and pop_lru() call no listener
+    cache.put(4, 40);
+    CHECK(cache.pop_lru()->first == 4);
+    CHECK((events == std::vector<Event>{{'e', 1, true}, {'r', 2, false}}));
+    CHECK(cache.dirty_count() == 0);
+}
+
+void TestDirtyTracking() {
+    LRUCache<int, int> cache(8);
+    cache.put(1, 1, true);
+    cache.put(2, 2);
+    cache.put(3, 3, true);
+    cache.put(1, 100);  // a clean put over a dirty entry keeps it dirty
+    CHECK(cache.mark_dirty(2));
+    CHECK(!cache.mark_dirty(42));
+    cache.put(3, 300, true);  // already dirty: keeps its place in the flush order
+    CHECK(cache.dirty_count() == 3);
+
+    std::vector<std::pair<int, int>> written;
+    auto write = [&](std::vector<std::pair<int, int>>& batch) {
+        written.insert(written.end(), batch.begin(), batch.end());
+    };
+    CHECK(cache.flush_dirty(write, 2) == 2);
+    CHECK((written == std::vector<std::pair<int, int>>{{1, 100}, {3, 300}}));  // oldest modification first
+    CHECK(cache.dirty_count() == 1);
+    CHECK(cache.flush_dirty(write, 8) == 1);
+    CHECK(written.back() == std::make_pair(2, 2));
+    CHECK(cache.flush_dirty(write, 8) == 0);
+
+    // A failed write-back leaves the batch dirty.
+    cache.put(4, 4, true);
+    cache.put(5, 5, true);
+    CHECK(cache.erase(4));
+    bool threw = false;
+    try {
+        cache.flush_dirty([](std::vector<std::pair<int, int>>& batch) {
+            CHECK(batch.size() == 1 && batch[0].first == 5);
+            throw std::runtime_error("disk full");
+        }, 8);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(cache.dirty_count() == 1);
+    written.clear();
+    CHECK(cache.flush_dirty(write, 8) == 1 && written[0].first == 5);
+}
+
+void TestThrowingListener() {
+    LRUCache<int, int> cache(2);
+    cache.set_eviction_listener([](int&&, int&&, bool) { throw std::runtime_error("evict"); });
+    cache.set_removal_listener([](int&&, int&&, bool) { throw std::runtime_error("remove"); });
+    cache.put(1, 1, true);
+    cache.put(2, 2);
+    bool threw = false;
+    try {
+        cache.put(3, 3);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    // The new entry stays, the victim is dropped with its dirty state.
+    CHECK(threw);
+    CHECK(cache.size() == 2 && cache.contains(3) && !cache.contains(1));
+    CHECK(cache.dirty_count() == 0);
+
+    threw = false;
+    try {
+        cache.erase(2);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(cache.size() == 1 && !cache.contains(2));
+}
+
+/** @brief Shrinking evicts a bounded number of entries per call, oldest first. */
+void TestShrink() {
+    LRUCache<int, int> cache(32);
+    std::vector<int> evicted;
+    cache.set_eviction_listener([&](int&& key, int&&, bool) { evicted.push_back(key); });
+    for (int i = 0; i < 32; ++i) cache.put(i, i);
+
+    cache.set_capacity(4);
+    CHECK(cache.capacity() == 4 && cache.size() == 32 && cache.over_capacity());
+    CHECK(cache.get(31) == 31);  // each operation evicts at most 8
+    CHECK(cache.size() == 24);
+    CHECK(cache.get(31) == 31);
+    CHECK(cache.get(31) == 31);
+    CHECK(cache.size() == 8);
+    cache.put(100, 100);
+    CHECK(cache.size() == 4 && !cache.over_capacity());
+    for (int key : {29, 30, 31, 100}) CHECK(cache.contains(key));
+    CHECK(evicted.size() == 29);
+    for (int i = 0; i < 29; ++i) CHECK(evicted[i] == i);
+
+    cache.set_capacity(2);
+    CHECK(cache.evict_step(1) == 1);
+    CHECK(cache.evict_step(8) == 1);
+    CHECK(cache.evict_step(8) == 0);
+    CHECK(cache.size() == 2 && cache.contains(31) && cache.contains(100));
+
+    cache.set_capacity(8);  // growing evicts nothing
+    for (int i = 0; i < 6; ++i) cache.put(i, i);
+    CHECK(cache.size() == 8 && evicted.size() == 31);
+
+    for (int capacity : {0, -1}) {
+        bool threw = false;
+        try {
+            cache.set_capacity(capacity);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        CHECK(threw && cache.capacity() == 8);
+    }
+
+    // A read that evicts can throw from the listener.
+    cache.set_eviction_listener([](int&&, int&&, bool) { throw std::runtime_error("evict"); });
+    cache.set_capacity(7);
+    bool threw = false;
+    try {
+        cache.get(5);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw && cache.size() == 7 && cache.contains(5));
+}
+
+} // namespace
+
+int main() {
+    TestStringViewLookup();
+    TestPrehashedLookup();
+    TestListeners();
+    TestDirtyTracking();
+    TestThrowingListener();
+    TestShrink();
+    std::printf("lru_cache_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file lru_k_cache_test.cpp
+ * @brief Checks LRU_K_Cache's capacity bound, shrinking and retained
+ *        history, the access-type hints of LRU_K_Cache and LRUKReplacer, and
+ *        the replacer's victim order, pinning and removal.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -Isrc -Itests tests/lru_k_cache_test.cpp -o lru_k_cache_test
+ */
+
+#include <cstdio>
+#include <stdexcept>
+#include <type_traits>
+
+#include "check.hpp"
+#include "lru_k_replacer.hpp"
+
+using Collections::AccessType;
+using Collections::LRU_K_Cache;
+using Collections::LRUKReplacer;
+
+namespace {
+
+template <size_t Depth>
+void Put(LRU_K_Cache<int, int, Depth>& cache, int key, AccessType type = AccessType::kUnknown) {
+    cache.Put(int(key), int(key), type);
+}
+
+/** @brief Capacity bounds the size even when no entry reaches K accesses. */
+void TestHardBound() {
+    LRU_K_Cache<int, int, 3> cache(16);
+    for (int i = 0; i < 1000; ++i) {
+        Put(cache, i);
+        if (i % 2 == 0) CHECK(cache.Get(i).has_value());  // two accesses, still below K
+        CHECK(cache.size() <= 16);
+    }
+    CHECK(cache.size() == 16);
+    for (int i = 1000 - 16; i < 1000; ++i) CHECK(cache.contains(i));  // oldest first access goes first
+
+    bool threw = false;
+    try {
+        LRU_K_Cache<int, int, 3> empty(0);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+/** @brief Shrinking evicts a bounded number of entries per call, in LRU-K order. */
+void TestShrink() {
+    LRU_K_Cache<int, int, 2> cache(32);
+    for (int i = 0; i < 32; ++i) Put(cache, i);
+
+    cache.set_capacity(4);
+    CHECK(cache.capacity() == 4 && cache.size() == 32);
+    CHECK(cache.Get(31).has_value());  // each operation evicts at most 8
+    CHECK(cache.size() == 24 && !cache.contains(7) && cache.contains(8));
+    CHECK(cache.Get(30).has_value());
+    CHECK(cache.size() == 16);
+    CHECK(cache.evict_step(100) == 12);  // sub-K 16 to 27 go before hot 30 and 31
+    CHECK(cache.evict_step(100) == 0);
+    for (int key : {28, 29, 30, 31}) CHECK(cache.contains(key));
+
+    cache.set_capacity(6);  // growing evicts nothing
+    Put(cache, 40);
+    Put(cache, 41);
+    CHECK(cache.size() == 6);
+
+    bool threw = false;
+    try {
+        cache.set_capacity(0);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw && cache.capacity() == 6);
+}
+
+/** @brief A key evicted and re-inserted resumes its history and outranks hot keys. */
+void TestRetainedHistory() {
+    LRU_K_Cache<int, int, 2> cache(2);
+    cache.set_retained_history(2);
+    Put(cache, 1);
+    CHECK(cache.Get(1).has_value());  // 1 has K = 2 accesses
+    Put(cache, 2);
+    Put(cache, 3);                    // evicts 2, the only sub-K key
+    Put(cache, 2);                    // evicts 3; 2 resumes its access and reaches K
+    CHECK(cache.ghost_size() == 1);   // the ghost of 3; the one of 2 was taken
+    Put(cache, 4);                    // no sub-K key resident: the oldest K-th access, 1, goes
+    CHECK(!cache.contains(1) && cache.contains(2));
+
+    Put(cache, 5);                    // evicts 4; the ghost of 3 is dropped, oldest first
+    CHECK(cache.ghost_size() == 2);
+    Put(cache, 3);                    // evicts 5; 3 has no ghost left and stays sub-K
+    Put(cache, 6);
+    CHECK(!cache.contains(3) && cache.contains(2));
+}
+
+void TestGhostAgeLimit() {
+    LRU_K_Cache<int, int, 2> cache(1);
+    cache.set_retained_history(8, 2);
+    Put(cache, 1);
+    Put(cache, 2);                    // evicts 1 with one access
+    for (int i = 0; i < 4; ++i) CHECK(cache.Get(2).has_value());
+    Put(cache, 1);                    // its ghost is older than 2 ticks: starts afresh
+    Put(cache, 3);                    // sub-K 1 is evicted, not a resumed 1
+    CHECK(!cache.contains(1) && cache.contains(3));
+}
+
+/** @brief A scanned or prefetched entry requeues at its first real access. */
+void TestHintedAdmission(AccessType admitted_by, AccessType first_access) {
+    LRU_K_Cache<int, int, 2> cache(3);
+    Put(cache, 1, admitted_by);
+    Put(cache, 2);
+    Put(cache, 3);
+    CHECK(cache.Get(1, AccessType::kScan).has_value());  // not a real access
+    CHECK(cache.Get(1, first_access).has_value());       // now newest in the sub-K FIFO
+    Put(cache, 4);
+    CHECK(cache.contains(1) && !cache.contains(2));
+    Put(cache, 5);
+    CHECK(cache.contains(1) && !cache.contains(3));
+    Put(cache, 6);
+    CHECK(!cache.contains(1));
+}
+
+/** @brief The same for replacer frames. */
+void TestHintedFrames(AccessType admitted_by, AccessType first_access) {
+    LRUKReplacer replacer(3, 2);
+    replacer.RecordAccess(0, admitted_by);
+    replacer.RecordAccess(1);
+    replacer.RecordAccess(2);
+    replacer.RecordAccess(0, first_access);
+    for (int frame = 0; frame < 3; ++frame) replacer.SetEvictable(frame, true);
+    CHECK(replacer.Evict() == 1);
+    CHECK(replacer.Evict() == 2);
+    CHECK(replacer.Evict() == 0);
+}
+
+/** @brief Sub-K frames leave first, oldest first access first, then by K-th most recent access. */
+void TestReplacerOrder() {
+    LRUKReplacer replacer(7, 2);
+    for (int frame = 0; frame < 5; ++frame) replacer.RecordAccess(frame);
+    replacer.RecordAccess(0);
+    replacer.RecordAccess(1);  // 0 and 1 reach K
+    CHECK(replacer.Size() == 0);  // tracked frames start pinned
+    CHECK(!replacer.Evict().has_value());
+
+    for (int frame = 0; frame < 5; ++frame) replacer.SetEvictable(frame, true);
+    replacer.SetEvictable(0, true);  // already evictable: counted once
+    CHECK(replacer.Size() == 5);
+    replacer.SetEvictable(4, false);
+    CHECK(replacer.Size() == 4);
+
+    CHECK(replacer.Evict() == 2);
+    CHECK(replacer.Evict() == 3);
+    CHECK(replacer.Evict() == 0);
+    replacer.SetEvictable(4, true);
+    CHECK(replacer.Evict() == 4);  // sub-K, so ahead of 1
+    CHECK(replacer.Evict() == 1);
+    CHECK(!replacer.Evict().has_value() && replacer.Size() == 0);
+
+    // An evicted frame is forgotten: it starts over, pinned.
+    replacer.RecordAccess(5);
+    replacer.RecordAccess(0);
+    replacer.SetEvictable(5, true);
+    replacer.SetEvictable(0, true);
+    CHECK(replacer.Evict() == 5);
+}
+
+/** @brief Remove() forgets an evictable frame; the documented misuses throw. */
+void TestReplacerRemove() {
+    LRUKReplacer replacer(4, 2);
+    for (int frame = 0; frame < 3; ++frame) {
+        replacer.RecordAccess(frame);
+        replacer.SetEvictable(frame, true);
+    }
+    replacer.Remove(0);
+    replacer.Remove(3);  // untracked: ignored
+    CHECK(replacer.Size() == 2);
+    CHECK(replacer.Evict() == 1);
+
+    replacer.RecordAccess(0);  // tracked afresh, pinned
+    auto throws = [](auto op) {
+        try {
+            op();
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    CHECK(throws([&] { replacer.Remove(0); }));  // pinned
+    CHECK(throws([&] { replacer.SetEvictable(3, true); }));  // never accessed
+    CHECK(throws([&] { replacer.RecordAccess(4); }));  // out of range
+    CHECK(throws([&] { replacer.SetEvictable(-1, true); }));
+    CHECK(throws([] { LRUKReplacer bad(4, 0); }));
+    CHECK(replacer.Size() == 1);
+
+    replacer.SetEvictable(0, true);
+    replacer.Remove(0);
+    CHECK(replacer.Evict() == 2);
+    CHECK(replacer.Size() == 0);
+}
+
+} // namespace
+
+int main() {
+    // K has a default only when it is fixed at compile time.
+    static_assert(std::is_constructible_v<LRU_K_Cache<int, int, 2>, size_t>);
+    static_assert(!std::is_constructible_v<LRU_K_Cache<int, int>, size_t>);
+    static_assert(std::is_constructible_v<LRU_K_Cache<int, int>, size_t, size_t>);
+
+    TestHardBound();
+    TestShrink();
+    TestRetainedHistory();
+    TestGhostAgeLimit();
+    for (AccessType admitted_by : {AccessType::kScan, AccessType::kPrefetch}) {
+        for (AccessType first_access : {AccessType::kLookup, AccessType::kIndex, AccessType::kUnknown}) {
+            TestHintedAdmission(admitted_by, first_access);
+            TestHintedFrames(admitted_by, first_access);
+        }
+    }
+    TestReplacerOrder();
+    TestReplacerRemove();
+    std::printf("lru_k_cache_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file lz_codec_test.cpp
+ * @brief Round-trips LZCodec blocks and feeds Decompress() malformed input.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -Isrc -Itests tests/lz_codec_test.cpp -o lz_codec_test
+ */
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "compressed_lru_cache.hpp"
+#include "lz_codec.hpp"
+
+using Collections::CompressedCacheOptions;
+using Collections::CompressedLRUCache;
+using Collections::LZCodec;
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+/** @brief Inputs from incompressible to highly repetitive, around the length-byte boundaries. */
+Bytes Sample(std::mt19937& rng, size_t size, int kind) {
+    Bytes bytes(size);
+    for (size_t i = 0; i < size; ++i) {
+        switch (kind) {
+        case 0: bytes[i] = static_cast<uint8_t>(rng()); break;          // random
+        case 1: bytes[i] = 'a'; break;                                   // one long run
+        case 2: bytes[i] = static_cast<uint8_t>("abcdefg"[i % 7]); break;  // short period
+        default:                                                         // words with noise
+            bytes[i] = rng() % 16 == 0 ? static_cast<uint8_t>(rng()) : static_cast<uint8_t>('a' + (i / 5) % 9);
+            break;
+        }
+    }
+    return bytes;
+}
+
+void TestRoundTrip() {
+    LZCodec codec;  // one instance, so later blocks see the previous blocks' table entries
+    std::mt19937 rng(1);
+    const size_t sizes[] = {0, 1, 3, 4, 5, 14, 15, 16, 19, 20, 269, 270, 271, 1000, 65535, 65536, 70000, 300000};
+    for (int round = 0; round < 3; ++round) {
+        for (size_t size : sizes) {
+            for (int kind = 0; kind < 4; ++kind) {
+                Bytes input = Sample(rng, size, kind);
+                Bytes block = codec.Compress(input);
+                CHECK(LZCodec::Decompress(block, input.size()) == input);
+                if (kind == 1 && size >= 1000) CHECK(block.size() < size / 50);
+                // A wrong size must be rejected, not silently truncated or padded.
+                CHECK(!LZCodec::Decompress(block, input.size() + 1).has_value());
+                if (size > 0) CHECK(!LZCodec::Decompress(block, input.size() - 1).has_value());
+            }
+        }
+    }
+}
+
+/** @brief Every decode of garbage either fails or yields exactly the requested size. */
+void Expect(const Bytes& block, size_t original_size) {
+    std::optional<Bytes> out = LZCodec::Decompress(block, original_size);
+    if (out.has_value()) CHECK(out->size() == original_size);
+}
+
+void TestMalformedInput() {
+    LZCodec codec;
+    std::mt19937 rng(2);
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        Bytes input = Sample(rng, rng() % 2000, static_cast<int>(rng() % 4));
+        Bytes block = codec.Compress(input);
+
+        Bytes mutated = block;
+        int flips = 1 + static_cast<int>(rng() % 4);
+        for (int f = 0; f < flips && !mutated.empty(); ++f) mutated[rng() % mutated.size()] = static_cast<uint8_t>(rng());
+        Expect(mutated, input.size());
+
+        if (!block.empty()) {
+            Bytes truncated(block.begin(), block.begin() + static_cast<long>(rng() % block.size()));
+            Expect(truncated, input.size());
+        }
+
+        Bytes garbage(rng() % 64);
+        for (uint8_t& byte : garbage) byte = static_cast<uint8_t>(rng());
+        Expect(garbage, rng() % 4096);
+    }
+}
+
+void TestCompressedCacheColdHits() {
+    CompressedCacheOptions options;
+    options.hot_capacity = 4;
+    options.compress_threshold = 64;
+    CompressedLRUCache<int> cache(options);
+    std::mt19937 rng(3);
+    std::vector<Bytes> values;
+    for (int i = 0; i < 32; ++i) {
+        values.push_back(Sample(rng, 500 + i, i % 4));
+        cache.put(i, values.back());
+    }
+    CHECK(cache.cold_size() == 28);
+    CHECK(cache.stored_bytes() < cache.logical_bytes());
+    for (int i = 0; i < 32; ++i) CHECK(cache.get(i) == values[i]);
+
+    size_t logical = 0;
+    for (const Bytes& value : values) logical += value.size();
+    CHECK(cache.size() == 32);
+    CHECK(cache.logical_bytes() == logical);
+}
+
+} // namespace
+
+int main() {
+    TestRoundTrip();
+    TestMalformedInput();
+    TestCompressedCacheColdHits();
+    std::printf("lz_codec_test: ok\n");
+    return 0;
+}
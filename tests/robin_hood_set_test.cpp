@@ -0,0 +1,131 @@
+/**
+ * @file robin_hood_set_test.cpp
+ * @brief Checks RobinHoodSet against std::unordered_set, including keys that
+ *        collide past kMaxProbe, and its load factor bound.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -Isrc -Itests tests/robin_hood_set_test.cpp -o robin_hood_set_test
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include "check.hpp"
+#include "robin_hood_set.hpp"
+
+using Collections::RobinHoodSet;
+
+namespace {
+
+template <typename K>
+void CheckSame(const RobinHoodSet<K>& set, const std::unordered_set<K>& model) {
+    CHECK(set.size() == model.size());
+    size_t visited = 0;
+    for (K key : set) {
+        CHECK(model.count(key) == 1);
+        ++visited;
+    }
+    CHECK(visited == model.size());
+}
+
+/**
+ * @brief The n-th key of a universe, optionally crowded onto few homes.
+ *
+ * Crowded keys are (n << 46) times the inverse of the Fibonacci multiplier,
+ * so key n lands in home n >> (18 - log2(capacity)). Below 2^18 slots
+ * many keys share one home, inserts overflow kMaxProbe and erases
+ * shift long clusters.
+ */
+template <typename K>
+K KeyOf(uint64_t n, bool crowded) {
+    return static_cast<K>(crowded ? (n << 46) * 0xF1DE83E19937733DULL : n * 7);
+}
+
+/** @brief Random operations over a universe of 2000 keys. */
+template <typename K>
+void TestMatchesUnorderedSet(uint32_t seed, bool crowded, float load) {
+    RobinHoodSet<K> set;
+    set.max_load_factor(load);
+    std::unordered_set<K> model;
+    std::mt19937_64 rng(seed);
+    for (int op = 0; op < 200000; ++op) {
+        K key = KeyOf<K>(rng() % 2000, crowded);
+        switch (rng() % 8) {
+        case 0:
+        case 1:
+            CHECK(set.erase(key) == (model.erase(key) == 1));
+            break;
+        case 2:
+        case 3:
+        case 4:
+            CHECK(set.insert(key) == model.insert(key).second);
+            break;
+        case 5:
+            if (rng() % 2000 == 0) {
+                RobinHoodSet<K> copy(set);
+                CheckSame(copy, model);
+                set = std::move(copy);
+            } else if (rng() % 2000 == 1) {
+                set.reserve(rng() % 4096);
+            } else if (rng() % 4000 == 2) {
+                set.clear();
+                model.clear();
+            }
+            break;
+        default: {
+            std::vector<K> keys(1 + rng() % 32);
+            for (K& probe : keys) probe = KeyOf<K>(rng() % 2000, crowded);
+            std::unique_ptr<bool[]> hits(new bool[keys.size()]);
+            size_t expected = 0;
+            for (K probe : keys) expected += model.count(probe);
+            CHECK(set.contains_many(keys, std::span<bool>(hits.get(), keys.size())) == expected);
+            for (size_t i = 0; i < keys.size(); ++i) CHECK(hits[i] == (model.count(keys[i]) == 1));
+            break;
+        }
+        }
+        CHECK(set.size() == model.size());
+        CHECK(set.load_factor() <= set.max_load_factor());
+    }
+    CheckSame(set, model);
+}
+
+void TestLoadFactorBound() {
+    RobinHoodSet<uint64_t> set;
+    set.max_load_factor(RobinHoodSet<uint64_t>::kMaxLoadFactor);
+    for (float load : {0.0f, -0.5f, 0.96f, 1.0f}) {
+        bool threw = false;
+        try {
+            set.max_load_factor(load);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+
+    // Random keys fill a table to the bound before it grows.
+    set.reserve(60000);
+    size_t capacity = set.bucket_count();
+    size_t limit = static_cast<size_t>(capacity * set.max_load_factor());
+    std::mt19937_64 rng(4);
+    while (set.size() < limit) set.insert(rng());
+    CHECK(set.bucket_count() == capacity);
+    while (!set.insert(rng())) {}
+    CHECK(set.bucket_count() == 2 * capacity);
+}
+
+} // namespace
+
+int main() {
+    TestMatchesUnorderedSet<uint64_t>(1, false, 0.9f);
+    TestMatchesUnorderedSet<uint64_t>(2, true, 0.95f);
+    TestMatchesUnorderedSet<int32_t>(3, false, 0.5f);
+    TestLoadFactorBound();
+    std::printf("robin_hood_set_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file shared_lru_cache_test.cpp
+ * @brief Checks SharedLRUCache recovery after a process dies holding the
+ *        lock, and after a failed recovery.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -pthread -Isrc -Itests tests/shared_lru_cache_test.cpp -o shared_lru_cache_test -lrt
+ */
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "check.hpp"
+#include "shared_lru_cache.hpp"
+
+using Collections::SharedLRUCache;
+
+namespace {
+
+/**
+ * @brief Identity hash that can be armed to kill the process or throw on
+ *        its Nth call, i.e. at a chosen point inside a cache operation.
+ */
+struct TrapHash {
+    enum Action { kNone, kExit, kThrow };
+    static inline Action action = kNone;
+    static inline int calls_left = 0;
+
+    size_t operator()(uint64_t key) const {
+        if (action != kNone && calls_left-- == 0) {
+            if (action == kExit) _exit(0);
+            action = kNone;
+            throw std::runtime_error("hash");
+        }
+        return key;
+    }
+};
+
+using Cache = SharedLRUCache<uint64_t, uint64_t, TrapHash>;
+
+constexpr uint32_t kCapacity = 64;
+
+std::string SegmentName() { return "/shared_lru_cache_test_" + std::to_string(getpid()); }
+
+/** @brief Runs `body` in a child process that is expected to die inside it. */
+template <typename Body>
+void InChild(Body body) {
+    pid_t pid = fork();
+    CHECK(pid >= 0);
+    if (pid == 0) {
+        body();
+        _exit(1);
+    }
+    int status = 0;
+    CHECK(waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+void Fill(Cache& cache) {
+    for (uint64_t k = 0; k < kCapacity; ++k) cache.put(k, k * 10);
+}
+
+/**
+ * @brief Dies on each hash call of put() into a full cache: looking up the
+ *        key, looking up the victim, and indexing the new slot after the
+ *        victim left and the slot was published.
+ */
+void TestOwnerDeath(const std::string& name) {
+    for (int point = 0; point < 3; ++point) {
+        Cache::Remove(name);
+        Cache cache(name, kCapacity);
+        Fill(cache);
+
+        InChild([&] {
+            Cache child(name, kCapacity);
+            TrapHash::action = TrapHash::kExit;
+            TrapHash::calls_left = point;
+            child.put(1000, 1);
+        });
+
+        CHECK(cache.recoveries() == 1);
+        size_t size = cache.size();
+        CHECK(size >= kCapacity - 1 && size <= kCapacity);
+        // Entries other than the victim (key 0) survive.
+        for (uint64_t k = 1; k < kCapacity; ++k) CHECK(cache.get(k) == k * 10);
+        if (point == 2) CHECK(cache.get(1000) == 1u);
+
+        // The structure is usable again.
+        for (uint64_t k = 2000; k < 2000 + 3 * kCapacity; ++k) cache.put(k, k);
+        CHECK(cache.size() == kCapacity);
+        for (uint64_t k = 2000 + 2 * kCapacity; k < 2000 + 3 * kCapacity; ++k) CHECK(cache.get(k) == k);
+        CHECK(cache.recoveries() == 1);
+    }
+}
+
+/** @brief A throwing rebuild releases the lock and is retried by the next locker. */
+void TestFailedRecovery(const std::string& name) {
+    Cache::Remove(name);
+    Cache cache(name, kCapacity);
+    Fill(cache);
+
+    InChild([&] {
+        Cache child(name, kCapacity);
+        TrapHash::action = TrapHash::kExit;
+        TrapHash::calls_left = 2;
+        child.put(1000, 1);
+    });
+
+    TrapHash::action = TrapHash::kThrow;
+    TrapHash::calls_left = 5;
+    bool threw = false;
+    try {
+        cache.get(1);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(cache.recoveries() == 1);  // the lock was released and the rebuild retried
+    CHECK(cache.size() == kCapacity);
+    CHECK(cache.get(1000) == 1u);
+    for (uint64_t k = 1; k < kCapacity; ++k) CHECK(cache.get(k) == k * 10);
+}
+
+} // namespace
+
+int main() {
+    std::string name = SegmentName();
+    TestOwnerDeath(name);
+    TestFailedRecovery(name);
+    Cache::Remove(name);
+    std::printf("shared_lru_cache_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file striped_lru_k_cache_test.cpp
+ * @brief Checks StripedLRUKCache's global victim order against LRU_K_Cache,
+ *        Remove(), and the size bound under concurrent Put().
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -pthread -Isrc -Itests tests/striped_lru_k_cache_test.cpp -o striped_lru_k_cache_test
+ *
+ * Also run it under -fsanitize=thread.
+ */
+
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "check.hpp"
+#include "lru_k_replacer.hpp"
+#include "striped_lru_k_cache.hpp"
+
+using Collections::LRU_K_Cache;
+using Collections::StripedLRUKCache;
+
+namespace {
+
+/**
+ * @brief Run serially, the sharded cache evicts exactly what one LRU-K cache
+ *        evicts: the clock is global, so ranks compare across shards.
+ */
+void TestMatchesLRUKCache() {
+    StripedLRUKCache<int, int, 2> cache(64, 2, 8);
+    LRU_K_Cache<int, int, 2> model(64);
+    CHECK(cache.shard_count() == 8);
+
+    std::mt19937 rng(11);
+    for (int op = 0; op < 100000; ++op) {
+        int key = static_cast<int>(rng() % 200);
+        switch (rng() % 8) {
+        case 0:
+            CHECK(cache.Remove(key) == model.Remove(key));
+            break;
+        case 1:
+        case 2:
+        case 3:
+            CHECK(cache.Get(key) == model.Get(key));
+            break;
+        default:
+            cache.Put(key, op);
+            model.Put(int(key), int(op));
+            break;
+        }
+        CHECK(cache.size() == model.size());
+        if (op % 1000 == 0) {
+            for (int k = 0; k < 200; ++k) CHECK(cache.contains(k) == model.contains(k));
+        }
+    }
+}
+
+/** @brief Sub-K keys leave first, oldest first, whichever shard holds them. */
+void TestVictimOrder() {
+    StripedLRUKCache<int, int, 2> cache(8, 2, 4);
+    for (int key = 0; key < 8; ++key) cache.Put(key, key);
+    for (int key = 0; key < 4; ++key) CHECK(cache.Get(key) == key);  // 0..3 reach K
+
+    cache.Put(8, 8);
+    cache.Put(9, 9);
+    CHECK(!cache.contains(4) && !cache.contains(5));
+    for (int key = 0; key < 4; ++key) CHECK(cache.contains(key));
+
+    // With no sub-K key left, the oldest second-to-last access goes.
+    for (int key = 6; key < 10; ++key) CHECK(cache.Get(key) == key);
+    cache.Put(10, 10);
+    CHECK(!cache.contains(0) && cache.contains(1) && cache.contains(10));
+}
+
+void TestRemove() {
+    StripedLRUKCache<int, int, 2> cache(4, 2, 4);
+    for (int key = 0; key < 4; ++key) cache.Put(key, key);
+    CHECK(cache.Remove(0));
+    CHECK(!cache.Remove(0));
+    CHECK(!cache.Remove(42));
+    CHECK(cache.size() == 3 && !cache.contains(0) && !cache.Get(0).has_value());
+
+    cache.Put(4, 4);  // fills the freed slot without evicting
+    CHECK(cache.size() == 4 && cache.contains(1));
+    cache.Put(5, 5);  // 1 is now the oldest
+    CHECK(!cache.contains(1) && cache.contains(4) && cache.contains(5));
+    for (int key : {2, 3, 4, 5}) CHECK(cache.Remove(key));
+    CHECK(cache.size() == 0);
+}
+
+/** @brief Racing insertions overshoot by at most one entry per thread. */
+void TestConcurrentPut() {
+    constexpr int kThreads = 4;
+    constexpr int kOps = 50000;
+    constexpr size_t kCapacity = 256;
+    StripedLRUKCache<int, int, 2> cache(kCapacity, 2, 16);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&cache, t] {
+            std::mt19937 rng(t);
+            for (int op = 0; op < kOps; ++op) {
+                int key = static_cast<int>(rng() % 4096);
+                if (rng() % 4 == 0) {
+                    if (std::optional<int> value = cache.Get(key)) CHECK(*value >= 0);
+                } else {
+                    cache.Put(key, op);
+                }
+                CHECK(cache.size() <= kCapacity + kThreads);
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    CHECK(cache.size() <= kCapacity + kThreads);
+
+    size_t present = 0;
+    for (int key = 0; key < 4096; ++key) present += cache.contains(key);
+    CHECK(present == cache.size());
+
+    cache.Put(-1, 0);  // a quiet insertion evicts the excess
+    CHECK(cache.size() == kCapacity && cache.contains(-1));
+}
+
+void TestConstruction() {
+    static_assert(std::is_constructible_v<StripedLRUKCache<int, int, 2>, size_t>);
+    static_assert(!std::is_constructible_v<StripedLRUKCache<int, int>, size_t>);
+
+    StripedLRUKCache<int, int> runtime(8, 3, 2);
+    for (int key = 0; key < 8; ++key) runtime.Put(key, key);
+    CHECK(runtime.Get(7) == 7 && runtime.shard_count() == 2);
+
+    for (auto make : {+[] { StripedLRUKCache<int, int, 2> cache(0); },
+                      +[] { StripedLRUKCache<int, int, 2> cache(8, 3); },
+                      +[] { StripedLRUKCache<int, int> cache(8, 0); }}) {
+        bool threw = false;
+        try {
+            make();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+}
+
+} // namespace
+
+int main() {
+    TestMatchesLRUKCache();
+    TestVictimOrder();
+    TestRemove();
+    TestConcurrentPut();
+    TestConstruction();
+    std::printf("striped_lru_k_cache_test: ok\n");
+    return 0;
+}
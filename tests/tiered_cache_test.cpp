@@ -0,0 +1,110 @@
+/**
+ * @file tiered_cache_test.cpp
+ * @brief Checks TieredCache demotion, batched disk reads and failing disk writes.
+ *
+ * Build:
+ *   g++ -std=c++20 -O2 -pthread -Isrc -Itests tests/tiered_cache_test.cpp -o tiered_cache_test
+ */
+
+#include <csignal>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "check.hpp"
+#include "lru_cache.hpp"
+#include "tiered_cache.hpp"
+
+using Collections::DiskTierOptions;
+using Collections::LRUCache;
+using Collections::TieredCache;
+
+namespace {
+
+DiskTierOptions Options(size_t read_threads) {
+    DiskTierOptions options;
+    options.directory = (std::filesystem::temp_directory_path() / "tiered_cache_test").string();
+    options.segment_bytes = 4096;
+    options.max_segments = 1000;
+    options.write_batch_bytes = 512;
+    options.read_threads = read_threads;
+    return options;
+}
+
+std::string ValueOf(int key) { return "value-" + std::to_string(key) + std::string(key % 50, 'x'); }
+
+void TestThrowingListenerDropsEntry() {
+    LRUCache<int, int> cache(2);
+    cache.set_eviction_listener([](int&&, int&&, bool) { throw std::runtime_error("listener"); });
+    cache.put(1, 1);
+    cache.put(2, 2);
+    bool threw = false;
+    try {
+        cache.put(3, 3);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(cache.size() == 2);  // the victim is gone and freed; LeakSanitizer checks the latter
+    CHECK(!cache.contains(1));
+    CHECK(cache.get(3) == 3);
+}
+
+void TestDemotionAndReadMany(size_t read_threads) {
+    TieredCache<int, std::string> cache(64, Options(read_threads));
+    for (int i = 0; i < 2000; ++i) cache.put(i, ValueOf(i));
+    CHECK(cache.memory_size() == 64);
+    CHECK(cache.disk_size() == 2000 - 64);
+    CHECK(cache.disk().segment_count() > 4);
+
+    std::vector<int> keys;
+    for (int i = 0; i < 2000; i += 7) keys.push_back(i);
+    keys.push_back(-1);
+    std::vector<std::optional<std::string>> values = cache.get_many(keys);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] < 0) CHECK(!values[i].has_value());
+        else CHECK(values[i] == ValueOf(keys[i]));
+    }
+    for (int i = 0; i < 2000; ++i) CHECK(cache.get(i) == ValueOf(i));
+}
+
+void TestFailingDiskWrite() {
+    TieredCache<int, std::string> cache(16, Options(0));
+    for (int i = 0; i < 16; ++i) cache.put(i, ValueOf(i));
+
+    // Writes past 1 KiB now fail with EFBIG instead of raising SIGXFSZ.
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit saved{};
+    getrlimit(RLIMIT_FSIZE, &saved);
+    rlimit limit = saved;
+    limit.rlim_cur = 1024;
+    setrlimit(RLIMIT_FSIZE, &limit);
+
+    int failures = 0;
+    for (int i = 16; i < 200; ++i) {
+        try {
+            cache.put(i, ValueOf(i));
+        } catch (const std::runtime_error&) {
+            ++failures;
+        }
+    }
+    setrlimit(RLIMIT_FSIZE, &saved);
+
+    CHECK(failures > 0);
+    CHECK(cache.memory_size() == 16);
+    for (int i = 184; i < 200; ++i) CHECK(cache.get(i) == ValueOf(i));
+}
+
+} // namespace
+
+int main() {
+    TestThrowingListenerDropsEntry();
+    TestDemotionAndReadMany(0);
+    TestDemotionAndReadMany(3);
+    TestFailingDiskWrite();
+    std::printf("tiered_cache_test: ok\n");
+    return 0;
+}